@@ -20,6 +20,15 @@
 #include <unordered_map>
 #include <string>
 #include <format>
+#include <functional>
+
+/*
+========================================================================================================================
+- - Local Includes - -
+========================================================================================================================
+*/
+
+#include "d_logger.hpp" // LOG_* macros
 
 /*
 ========================================================================================================================
@@ -29,6 +38,7 @@
 
 // Forward declarations to break circular dependencies:
 class D_Tile;
+class D_Tile_Index;
 class D_Map;
 
 /*
@@ -68,11 +78,43 @@ class D_Map;
  **********************************************************************************************************************/
 #define DEFAULT_TEST_OUTPUT_IMG_PATH "./imgs/TEST_output/"
 
+/***********************************************************************************************************************
+ * @brief Default tile manifest path, written by D_Tile::generate_tiles() and read on start to skip tile parsing. This
+ * is kept out of the loaded directory as every file in there is expected to be a tile.
+ **********************************************************************************************************************/
+#define DEFAULT_TILE_MANIFEST_PATH "./imgs/tile_manifest.dtm"
+
+/***********************************************************************************************************************
+ * @brief Default tile cache index path, records the content hash of every tile copied into the loaded directory so
+ * unchanged tiles are not copied again. @see D_Tile::sync_loaded_tiles()
+ **********************************************************************************************************************/
+#define DEFAULT_TILE_CACHE_PATH "./imgs/tile_cache.dtc"
+
+/***********************************************************************************************************************
+ * @brief Offset basis for the 64 bit FNV-1a hash. @see fnv1a_64()
+ **********************************************************************************************************************/
+#define FNV1A_64_OFFSET_BASIS (0xCBF2'9CE4'8422'2325ULL)
+
+/***********************************************************************************************************************
+ * @brief Prime for the 64 bit FNV-1a hash. @see fnv1a_64()
+ **********************************************************************************************************************/
+#define FNV1A_64_PRIME (0x0000'0100'0000'01B3ULL)
+
 /***********************************************************************************************************************
  * @brief Standard output quality of images when saving.
  **********************************************************************************************************************/
 #define DEFAULT_OUTPUT_QUALITY (100)
 
+/***********************************************************************************************************************
+ * @brief Standard zlib compression level (0 to 9) of PNG images when saving, low levels trade size for encode speed.
+ **********************************************************************************************************************/
+#define DEFAULT_PNG_COMPRESSION (1)
+
+/***********************************************************************************************************************
+ * @brief Thread count to fall back on when the available hardware threads cannot be detected.
+ **********************************************************************************************************************/
+#define DEFAULT_THREAD_COUNT (4)
+
 /***********************************************************************************************************************
  * @brief Produces a std::format from the passed error message. Adds filename, function name, line and an ERR
  * identifier.
@@ -81,13 +123,6 @@ class D_Map;
 #define ERR_FORMAT(msg) \
     std::format("ERR:{}:{}:{}: {}", __FILE__, __func__, __LINE__, msg)
 
-/***********************************************************************************************************************
- * @brief Prints the given message to std::cout along with filename, function name and line.
- * @param msg Message to be logged.
- **********************************************************************************************************************/
-#define LOG_DEBUG(msg) \
-    std::cout << "INF:" << __FILE__ << ":" << __func__ << ":" << __LINE__ << ":" << msg << std::endl
-
 /*
 ========================================================================================================================
 - - App Globals - -
@@ -116,6 +151,12 @@ extern std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> Exit_Map;
  **********************************************************************************************************************/
 extern std::shared_ptr<D_Tile> Empty_Tile;
 
+/***********************************************************************************************************************
+ * @brief Global connection index over the Tile_Map, rebuilt whenever tiles are loaded or generated and shared by every
+ * D_Map generating from the Tile_Map.
+ **********************************************************************************************************************/
+extern std::shared_ptr<D_Tile_Index const> Tile_Index;
+
 /***********************************************************************************************************************
  * @brief Global dungeon map for the application, will be used to keep track of what should be displayed in the GUI.
  **********************************************************************************************************************/
@@ -133,6 +174,28 @@ extern std::string Gen_Flag;
 */
 
 void init_img_dirs(void);
+unsigned int available_threads(void);
+void run_parallel(size_t job_count, std::function<void(size_t)> const &job);
+
+/***********************************************************************************************************************
+ * @brief Helper function to hash bytes with 64 bit FNV-1a, hashes can be chained by passing the previous result.
+ *
+ * @param[in] data Bytes to hash.
+ * @param[in] size Number of bytes to hash.
+ * @param[in] hash Hash to continue from, defaults to the FNV-1a offset basis.
+ *
+ * @retval uint64_t The resulting hash.
+ **********************************************************************************************************************/
+inline uint64_t fnv1a_64(void const *data, size_t size, uint64_t hash = FNV1A_64_OFFSET_BASIS)
+{
+    unsigned char const *bytes = static_cast<unsigned char const *>(data);
+    for (size_t idx = 0; idx < size; idx++)
+    {
+        hash ^= bytes[idx];
+        hash *= FNV1A_64_PRIME;
+    }
+    return hash;
+}
 
 /***********************************************************************************************************************
  * @brief Helper function to reverse 8 bits.
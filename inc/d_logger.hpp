@@ -0,0 +1,193 @@
+/***********************************************************************************************************************
+ * @date 2026-10-16
+ * @author Gregory Nitch
+ *
+ * @brief Header for the D_Logger class and the LOG_* macros, a leveled logger where each thread writes records into its
+ * own lock free ring buffer and a background writer thread drains them to std::cout. For documentation for each
+ * function @see d_logger.cpp.
+ **********************************************************************************************************************/
+
+#pragma once
+
+/*
+========================================================================================================================
+- - System Includes - -
+========================================================================================================================
+*/
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+========================================================================================================================
+- - Macros - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Log level values, kept as macros so D_LOG_COMPILE_LEVEL can be set from the command line. @see Log_Level
+ **********************************************************************************************************************/
+#define LOG_LEVEL_TRACE (0)
+#define LOG_LEVEL_DEBUG (1)
+#define LOG_LEVEL_INFO (2)
+#define LOG_LEVEL_WARN (3)
+#define LOG_LEVEL_ERROR (4)
+#define LOG_LEVEL_OFF (5)
+
+/***********************************************************************************************************************
+ * @brief Lowest level compiled in, log calls below it are removed entirely along with their message expressions.
+ * Trace is per cell generation logging and is left out unless asked for, ie -DD_LOG_COMPILE_LEVEL=0.
+ **********************************************************************************************************************/
+#ifndef D_LOG_COMPILE_LEVEL
+#define D_LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+/***********************************************************************************************************************
+ * @brief Records each thread's ring buffer can hold, a power of two. A thread finding its ring full waits for the writer.
+ **********************************************************************************************************************/
+#define LOG_RING_SIZE (1024)
+
+/***********************************************************************************************************************
+ * @brief Longest the writer thread sleeps between drains when no one wakes it, in milliseconds.
+ **********************************************************************************************************************/
+#define LOG_DRAIN_INTERVAL_MS (20)
+
+/***********************************************************************************************************************
+ * @brief Logs a message at a level with filename, function name and line. The message expression is only evaluated when
+ * the level is both compiled in and enabled at runtime, so formatting costs nothing for disabled levels.
+ * @param level LOG_LEVEL_* value to log at.
+ * @param msg Message to be logged, anything a std::string can be built from.
+ **********************************************************************************************************************/
+#define LOG_AT(level, msg)                                                                                 \
+    do                                                                                                     \
+    {                                                                                                      \
+        if constexpr ((level) >= D_LOG_COMPILE_LEVEL)                                                      \
+        {                                                                                                  \
+            if (D_Logger::enabled(static_cast<Log_Level>(level)))                                          \
+                D_Logger::write(static_cast<Log_Level>(level), __FILE__, __func__, __LINE__, (msg));       \
+        }                                                                                                  \
+    } while (0)
+
+/***********************************************************************************************************************
+ * @brief Level specific log macros. @see LOG_AT
+ * @param msg Message to be logged.
+ **********************************************************************************************************************/
+#define LOG_TRACE(msg) LOG_AT(LOG_LEVEL_TRACE, msg)
+#define LOG_DEBUG(msg) LOG_AT(LOG_LEVEL_DEBUG, msg)
+#define LOG_INFO(msg) LOG_AT(LOG_LEVEL_INFO, msg)
+#define LOG_WARN(msg) LOG_AT(LOG_LEVEL_WARN, msg)
+#define LOG_ERROR(msg) LOG_AT(LOG_LEVEL_ERROR, msg)
+
+/*
+========================================================================================================================
+- - Enums - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Log levels in increasing severity, values match the LOG_LEVEL_* macros.
+ **********************************************************************************************************************/
+enum class Log_Level : uint8_t
+{
+    Trace = LOG_LEVEL_TRACE,
+    Debug = LOG_LEVEL_DEBUG,
+    Info = LOG_LEVEL_INFO,
+    Warn = LOG_LEVEL_WARN,
+    Error = LOG_LEVEL_ERROR,
+    Off = LOG_LEVEL_OFF
+};
+
+/*
+========================================================================================================================
+- - Start of D_Logger Class - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Process wide asynchronous logger. Logging threads only move a record into their own single producer single
+ * consumer ring, the writer thread merges the rings by sequence number and writes the records out with one flush per
+ * drain.
+ *
+ * @members :
+ *      @private static std::atomic<uint8_t> runtime_level = Lowest level currently written.
+ *      @private static std::terminate_handler previous_terminate = Handler replaced by on_terminate().
+ *      @private static std::atomic<uint64_t> next_sequence = Sequence number of the next record, orders records across
+ *      threads.
+ *      @private std::vector<std::shared_ptr<Log_Ring>> rings = Ring of every thread that has logged.
+ *      @private std::mutex mtx = Guards the rings list and the drain state, backs both condition variables.
+ *      @private std::condition_variable wake_cv = Wakes the writer early, ie for a flush or a filling ring.
+ *      @private std::condition_variable drained_cv = Wakes flush() callers when a drain finishes.
+ *      @private uint64_t drains_started = Drains the writer has started.
+ *      @private uint64_t drains_done = Drains the writer has finished.
+ *      @private bool wake_requested = Set when the writer should drain without waiting out the interval.
+ *      @private bool stopping = Set on destruction, the writer drains once more and exits.
+ *      @private std::thread writer = Background thread draining the rings.
+ **********************************************************************************************************************/
+class D_Logger
+{
+public:
+    D_Logger(D_Logger const &) = delete;
+    D_Logger &operator=(D_Logger const &) = delete;
+    ~D_Logger();
+
+    static bool enabled(Log_Level level);
+    static void set_level(Log_Level level);
+    static Log_Level get_level();
+    static void write(Log_Level level, char const *file, char const *func, int line, std::string msg);
+    static void flush();
+
+private:
+    struct Log_Record
+    {
+        uint64_t sequence = 0;
+        Log_Level level = Log_Level::Debug;
+        char const *file = nullptr;
+        char const *func = nullptr;
+        int line = 0;
+        std::string msg;
+    };
+
+    struct Log_Ring
+    {
+        std::array<Log_Record, LOG_RING_SIZE> records;
+        alignas(64) std::atomic<size_t> head = 0; // Next slot to write, only advanced by the owning thread.
+        alignas(64) std::atomic<size_t> tail = 0; // Next slot to read, only advanced by the writer.
+        std::atomic<bool> retired = false;        // Set when the owning thread exits.
+    };
+
+    struct Ring_Owner
+    {
+        std::shared_ptr<Log_Ring> ring;
+        ~Ring_Owner();
+    };
+
+    static std::atomic<uint8_t> runtime_level;
+    static std::terminate_handler previous_terminate;
+    static std::atomic<uint64_t> next_sequence;
+
+    std::vector<std::shared_ptr<Log_Ring>> rings;
+    std::mutex mtx;
+    std::condition_variable wake_cv;
+    std::condition_variable drained_cv;
+    uint64_t drains_started = 0;
+    uint64_t drains_done = 0;
+    bool wake_requested = false;
+    bool stopping = false;
+    std::thread writer;
+
+    D_Logger();
+    static D_Logger &instance();
+    static Log_Ring &thread_ring();
+    static void on_terminate();
+    void wake_writer();
+    void writer_loop();
+    bool drain(std::string &out);
+};
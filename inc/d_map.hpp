@@ -16,10 +16,21 @@
 
 #include <cstdint>
 #include <deque>
+#include <filesystem>
+#include <functional>
 #include <vector>
 #include <string>
 #include <memory>
 #include <random>
+#include <unordered_map>
+
+/*
+========================================================================================================================
+- - 3rd Party Includes - -
+========================================================================================================================
+*/
+
+#include <QImage>
 
 /*
 ========================================================================================================================
@@ -28,6 +39,8 @@
 */
 
 #include "d_tile.hpp"
+#include "d_tile_index.hpp"
+#include "d_random.hpp"
 #include "d_builder_common.hpp"
 
 /*
@@ -46,6 +59,58 @@
  **********************************************************************************************************************/
 #define ONE_HUNDRED_PERCENT (100)
 
+/***********************************************************************************************************************
+ * @brief Tile handle of a map cell that has not been assigned a tile yet.
+ **********************************************************************************************************************/
+#define MAP_UNSET_TILE_HANDLE (UINT16_MAX)
+
+/***********************************************************************************************************************
+ * @brief Tile handle of a map cell that holds the Empty_Tile, the Empty_Tile need not be in the map's tile index.
+ **********************************************************************************************************************/
+#define MAP_EMPTY_TILE_HANDLE (UINT16_MAX - 1)
+
+/***********************************************************************************************************************
+ * @brief Times a batch item is regenerated from a new seed after hitting a dead end before the batch gives up.
+ **********************************************************************************************************************/
+#define MAP_BATCH_MAX_ATTEMPTS (64)
+
+/***********************************************************************************************************************
+ * @brief Backtracks the constraint solver may take within one attempt before it restarts from a new entrance.
+ **********************************************************************************************************************/
+#define MAP_SOLVER_MAX_BACKTRACKS (4096)
+
+/***********************************************************************************************************************
+ * @brief Cells a render must redraw before it is split into row bands across the shared thread pool.
+ **********************************************************************************************************************/
+#define MAP_RENDER_PARALLEL_MIN_CELLS (64)
+
+/***********************************************************************************************************************
+ * @brief Row bands per pool worker when rendering or encoding in parallel, more bands than workers lets work stealing
+ * even out bands of unequal cost.
+ **********************************************************************************************************************/
+#define MAP_RENDER_BANDS_PER_WORKER (4)
+
+/***********************************************************************************************************************
+ * @brief Width and height of the square tiles in each level of a saved Deep Zoom pyramid.
+ **********************************************************************************************************************/
+#define MAP_PYRAMID_TILE_SIZE (256)
+
+/***********************************************************************************************************************
+ * @brief Number of recently seen pixels a QOI encoder indexes, fixed by the format.
+ **********************************************************************************************************************/
+#define MAP_QOI_INDEX_SIZE (64)
+
+/***********************************************************************************************************************
+ * @brief Longest run of repeated pixels one QOI run op holds, fixed by the format.
+ **********************************************************************************************************************/
+#define MAP_QOI_MAX_RUN (62)
+
+/***********************************************************************************************************************
+ * @brief Attempts the constraint solver makes within one generate() before it gives up, only reached when the tile set
+ * cannot fill the map at all.
+ **********************************************************************************************************************/
+#define MAP_SOLVER_MAX_ATTEMPTS (64)
+
 /*
 ========================================================================================================================
 - - Globals - -
@@ -91,6 +156,79 @@ constexpr std::array<uint8_t, 4> TILE_NEIGHBOOR_SIDE_IDX_MIRRORS =
         1, // left = right
 };
 
+/*
+========================================================================================================================
+- - Start of Generation_Mode Enum - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief How a D_Map places tiles when generating a design. A seed only reproduces its design in the same mode.
+ *
+ * @remarks Values:
+ *      Greedy = Tiles are placed outwards from the entrance one cell at a time, a cell with no fitting tile is a dead
+ *               end and generation throws,
+ *      Propagate = Every cell holds a domain of the tiles that can still fit, each placement narrows its neighboors
+ *                  domains and a cell whose domain empties is resolved by backtracking, so dead ends never throw,
+ **********************************************************************************************************************/
+enum class Generation_Mode : uint8_t
+{
+    Greedy = 0,
+    Propagate = 1,
+};
+
+/*
+========================================================================================================================
+- - Start of Image_Encoder Enum - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Encoder a D_Map writes its design with when saving.
+ *
+ * @remarks Values:
+ *      Jpeg = Lossy, setting is the quality from 0 to 100,
+ *      Png = Lossless, setting is the zlib compression level from 0 (fastest, largest) to 9,
+ *      Ppm = Lossless binary PPM (P6), uncompressed RGB behind a short text header, alpha is dropped,
+ *      Qoi = Lossless Quite OK Image format, keeps alpha and encodes in one pass at close to memory speed,
+ **********************************************************************************************************************/
+enum class Image_Encoder : uint8_t
+{
+    Jpeg = 0,
+    Png = 1,
+    Ppm = 2,
+    Qoi = 3,
+};
+
+/*
+========================================================================================================================
+- - Start of D_Map_Layout - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief A generated map design detached from the D_Map that generated it, ie the result of a batch generation.
+ *
+ * @members:
+ *      @public uint16_t cols = width of the map.
+ *      @public uint16_t rows = height of the map.
+ *      @public uint8_t connection_chance = connection chance the map was generated with.
+ *      @public uint64_t seed = seed the map was generated from.
+ *      @public Generation_Mode generation_mode = mode the map was generated in.
+ *      @public std::shared_ptr<D_Tile_Index const> tile_index = index the tile handles refer to.
+ *      @public std::vector<uint16_t> tiles = row major grid of tile handles, @see D_Map::get_tile_grid().
+ **********************************************************************************************************************/
+struct D_Map_Layout
+{
+    uint16_t cols = 0;
+    uint16_t rows = 0;
+    uint8_t connection_chance = 0;
+    uint64_t seed = 0;
+    Generation_Mode generation_mode = Generation_Mode::Greedy;
+    std::shared_ptr<D_Tile_Index const> tile_index = nullptr;
+    std::vector<uint16_t> tiles;
+};
+
 /*
 ========================================================================================================================
 - - Start of D_Map - -
@@ -101,58 +239,211 @@ constexpr std::array<uint8_t, 4> TILE_NEIGHBOOR_SIDE_IDX_MIRRORS =
  * @brief Represents a map within the applications GUI.
  *
  * @members:
- *      @private std::vector<std::vector<std::shared_ptr<D_Tile>>> display_mat = matrix of tiles that make up the actual
- *               map.
- *      @private std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> theme_map = map of tiles to use during generation.
- *      @private std::deque<std::pair<uint8_t, uint8_t>> to_visit = points in the map which need to be visited and have
+ *      @private std::vector<uint16_t> tile_grid = row major grid of tile handles that make up the actual map, a handle
+ *               is a slot in the tile index or one of MAP_UNSET_TILE_HANDLE and MAP_EMPTY_TILE_HANDLE.
+ *      @private std::shared_ptr<D_Tile_Index const> tile_index = connection index of the tiles to use during generation.
+ *      @private std::vector<uint64_t> canidate_words = scratch bitset reused by every canidate query on the tile index.
+ *      @private std::deque<std::pair<uint16_t, uint16_t>> to_visit = points in the map which need to be visited and have
  *               a tile assigned to them
- *      @private std::random_device rd = random device used for number generation.
- *      @private std::mt19937 gen = random number generator.
- *      @private std::uniform_int_distribution<unsigned long> distr = random number distrobution object.
+ *      @private std::vector<uint64_t> queued_words = row major bitset of every point that has been placed in to_visit
+ *               during the current generation, ie so a point is never queued twice.
+ *      @private D_Map_Rng gen = random number generator, reseeded from the map's seed before each generation.
+ *               @see D_MAP_RNG_ENGINE
  *      @private std::string theme = theme of the map.
- *      @private uint8_t cols = width of the map.
- *      @private uint8_t rows = height of the map.
+ *      @private uint16_t cols = width of the map.
+ *      @private uint16_t rows = height of the map.
  *      @private uint8_t connection_chance = chances that a tile will connection in a possible (ie, empty) direction.
+ *      @private uint64_t seed = seed the current design was generated from.
+ *      @private Generation_Mode generation_mode = how designs are generated, @see Generation_Mode.
+ *      @private Solver_State solver = scratch state of the Propagate mode, reused between generations.
+ *      @private QImage canvas = composited image of the design, kept between renders so only dirty cells are redrawn.
+ *      @private std::vector<uint16_t> canvas_grid = row major handle drawn in each canvas cell, MAP_UNSET_TILE_HANDLE
+ *               for a cell left clear.
+ *      @private std::vector<uint64_t> dirty_words = row major bitset of cells that may differ from the canvas.
+ *      @private std::vector<int> canvas_col_x = pixel x of each column's left edge, plus the canvas width.
+ *      @private std::vector<int> canvas_row_y = pixel y of each row's top edge, plus the canvas height.
  **********************************************************************************************************************/
 class D_Map
 {
 public:
-    D_Map(uint8_t in_cols,
-          uint8_t in_rows,
+    D_Map(uint16_t in_cols,
+          uint16_t in_rows,
           uint8_t in_con_chance,
           std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles);
+    D_Map(uint16_t in_cols,
+          uint16_t in_rows,
+          uint8_t in_con_chance,
+          std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles,
+          uint64_t in_seed);
+    explicit D_Map(D_Map_Layout const &layout);
     ~D_Map();
+    static std::vector<D_Map_Layout> generate_batch(size_t count,
+                                                    uint16_t in_cols,
+                                                    uint16_t in_rows,
+                                                    uint8_t in_con_chance,
+                                                    uint64_t seed,
+                                                    std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles,
+                                                    Generation_Mode mode);
+    D_Map_Layout get_layout() const;
+    std::vector<char> encode_layout() const;
+    bool save_layout(std::string file_name) const;
+    static D_Map_Layout decode_layout(unsigned char const *data,
+                                      size_t size,
+                                      std::shared_ptr<D_Tile_Index const> tile_index);
+    static D_Map_Layout load_layout(std::filesystem::path const &file_path,
+                                    std::shared_ptr<D_Tile_Index const> tile_index);
     void generate();
-    void generate(uint8_t in_cols,
-                  uint8_t in_rows,
+    void generate(uint64_t in_seed);
+    void generate(uint16_t in_cols,
+                  uint16_t in_rows,
                   uint8_t in_con_chance,
                   std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles);
-    bool save(std::string file_name) const;
-    void swap_tile(uint8_t col, uint8_t row, std::shared_ptr<D_Tile> replacement);
+    QImage const &render();
+    QImage render_preview(size_t level = TILE_PREVIEW_LEVEL) const;
+    bool save(std::string file_name);
+    bool save(std::string file_name, Image_Encoder encoder, int setting = -1);
+    void render_strips(std::function<void(QImage const &strip, int strip_y)> const &sink);
+    bool save_streamed(std::string file_name);
+    bool save_pyramid(std::string file_name, Image_Encoder encoder = Image_Encoder::Jpeg, int setting = -1);
+    void swap_tile(uint16_t col, uint16_t row, std::shared_ptr<D_Tile> const &replacement);
+    void regenerate_region(uint16_t col0, uint16_t row0, uint16_t col1, uint16_t row1);
     std::string const to_string() const;
-    std::vector<std::vector<std::shared_ptr<D_Tile>>> const &get_display_mat();
+    D_Tile *get_tile(uint16_t col, uint16_t row) const;
+    D_Tile *get_tile_from_handle(uint16_t handle) const;
+    std::vector<uint16_t> const &get_tile_grid() const;
+    uint16_t get_cols() const;
+    uint16_t get_rows() const;
     uint8_t get_connection_chance() const;
+    uint64_t get_seed() const;
+    Generation_Mode get_generation_mode() const;
+    void set_generation_mode(Generation_Mode mode);
 
 private:
-    std::vector<std::vector<std::shared_ptr<D_Tile>>> display_mat;
-    std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> theme_map;
-    std::deque<std::pair<uint8_t, uint8_t>> to_visit;
-    std::random_device rd;
-    std::mt19937 gen;
-    std::uniform_int_distribution<unsigned long> distr;
+    std::vector<uint16_t> tile_grid;
+    std::shared_ptr<D_Tile_Index const> tile_index;
+    std::vector<uint64_t> canidate_words;
+    std::deque<std::pair<uint16_t, uint16_t>> to_visit;
+    std::vector<uint64_t> queued_words;
+    D_Map_Rng gen;
     std::string theme;
-    uint8_t cols;
-    uint8_t rows;
+    uint16_t cols;
+    uint16_t rows;
     uint8_t connection_chance; // Out of 100, values over or equal to 100 yield a 100% chance of connection.
+    uint64_t seed = 0;
+    Generation_Mode generation_mode = Generation_Mode::Greedy;
+
+    struct Deferred_Generate
+    {
+    };
+
+    /*******************************************************************************************************************
+     * @brief Scratch state of the Propagate mode. Domains are tile index domain bitsets, @see D_Tile_Index. The solver
+     * works on a window of the map, solver cells are row major within the window and everything outside it is fixed.
+     *
+     * @members:
+     *      @public uint16_t window_col = left column of the window.
+     *      @public uint16_t window_row = top row of the window.
+     *      @public uint16_t window_cols = width of the window.
+     *      @public uint16_t window_rows = height of the window.
+     *      @public size_t word_count = words in one cell's domain.
+     *      @public std::vector<uint64_t> domain_words = row major domains of every window cell, laid out as [cell][word].
+     *      @public std::vector<uint32_t> domain_sizes = number of slots in each cell's domain.
+     *      @public std::vector<uint32_t> trail_cells = cells whose domain changed, in order of change.
+     *      @public std::vector<uint32_t> trail_sizes = domain size of each trail cell before its change.
+     *      @public std::vector<uint64_t> trail_words = domain of each trail cell before its change.
+     *      @public std::vector<Decision> decisions = cells chosen so far, newest last.
+     *      @public std::vector<std::pair<uint64_t, uint32_t>> open_cells = min heap of cells that need a tile, keyed by
+     *              domain size then a random tie break. Entries go stale as domains change and are skipped.
+     *      @public std::vector<uint32_t> changed_cells = cells whose change has not been propagated yet.
+     *      @public std::vector<uint64_t> support_words = scratch domain for neighboor support.
+     *      @public std::vector<uint64_t> choice_words = scratch domain for picking a tile.
+     *      @public size_t backtracks = backtracks taken in the current attempt.
+     *******************************************************************************************************************/
+    struct Solver_State
+    {
+        struct Decision
+        {
+            uint32_t cell;
+            uint16_t handle;
+            size_t trail_mark;
+        };
 
+        uint16_t window_col = 0;
+        uint16_t window_row = 0;
+        uint16_t window_cols = 0;
+        uint16_t window_rows = 0;
+        size_t word_count = 0;
+        std::vector<uint64_t> domain_words;
+        std::vector<uint32_t> domain_sizes;
+        std::vector<uint32_t> trail_cells;
+        std::vector<uint32_t> trail_sizes;
+        std::vector<uint64_t> trail_words;
+        std::vector<Decision> decisions;
+        std::vector<std::pair<uint64_t, uint32_t>> open_cells;
+        std::vector<uint32_t> changed_cells;
+        std::vector<uint64_t> support_words;
+        std::vector<uint64_t> choice_words;
+        size_t backtracks = 0;
+    };
+
+    Solver_State solver;
+
+    QImage canvas;
+    std::vector<uint16_t> canvas_grid;
+    std::vector<uint64_t> dirty_words;
+    std::vector<int> canvas_col_x;
+    std::vector<int> canvas_row_y;
+
+    D_Map(uint16_t in_cols,
+          uint16_t in_rows,
+          uint8_t in_con_chance,
+          std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles,
+          Deferred_Generate);
+    void reseed(uint64_t in_seed);
+    uint32_t roll(uint32_t bound);
     void reset_for_generate(void);
     void start_generation_at_entrance(void);
-    std::shared_ptr<D_Tile> chose_tile_based_on_connections(D_Connections valid_connections,
-                                                            D_Connections possible_connections,
-                                                            std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> const &tile_map);
+    void set_tile_index(std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles);
+    uint16_t chose_tile_based_on_connections(D_Connections valid_connections, D_Connections possible_connections);
+    void set_cell(uint16_t col, uint16_t row, uint16_t handle);
+    bool queue_visit(uint16_t col, uint16_t row);
+    D_Connections get_cell_connections(uint16_t handle) const;
+    D_Connections get_cell_facing_connections(uint16_t handle) const;
     void place_nodes(void);
-    void calculate_connections_and_add_visitors(std::pair<uint8_t, uint8_t> const &current_point,
+    void calculate_connections_and_add_visitors(std::pair<uint16_t, uint16_t> const &current_point,
                                                 D_Connections &valid_connections,
                                                 D_Connections &possible_connections);
     void fill_empty_tiles(void);
+    void mark_dirty(uint16_t col, uint16_t row);
+    void mark_all_dirty(void);
+    void draw_cell(uint16_t handle,
+                   size_t level,
+                   int src_x,
+                   int src_y,
+                   uchar *cell_bits,
+                   int cell_width,
+                   int cell_height,
+                   qsizetype bytes_per_line) const;
+    void measure_pixel_layout(std::vector<int> &col_x, std::vector<int> &row_y, size_t level = 0) const;
+    QImage compose_rect(size_t level,
+                        std::vector<int> const &col_x,
+                        std::vector<int> const &row_y,
+                        int x,
+                        int y,
+                        int width,
+                        int height) const;
+    static int resolve_encoder_setting(Image_Encoder encoder, int setting);
+    static bool write_image(QImage const &image, std::string const &file_name, Image_Encoder encoder, int setting);
+    static void convert_to_rgb(QImage const &image, char *out);
+    static void encode_qoi(QImage const &image, std::vector<char> &out);
+    void solve_constraints(bool place_entrance);
+    void reset_solver(void);
+    size_t grid_cell(uint32_t cell) const;
+    bool start_solver_at_entrance(void);
+    bool is_open_cell(uint32_t cell) const;
+    void push_open_cell(uint32_t cell);
+    void set_domain(uint32_t cell, uint64_t const *new_words, uint32_t new_size);
+    bool propagate(void);
+    void decide(uint32_t cell);
+    bool backtrack(void);
 };
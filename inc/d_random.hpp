@@ -0,0 +1,210 @@
+/***********************************************************************************************************************
+ * @date 2026-10-16
+ * @author Gregory Nitch
+ *
+ * @brief Small random number engines and bounded sampling used by map generation. The engine D_Map generates with is
+ * chosen at compile time with D_MAP_RNG_ENGINE.
+ **********************************************************************************************************************/
+
+#pragma once
+
+/*
+========================================================================================================================
+- - System Includes - -
+========================================================================================================================
+*/
+
+#include <cstdint>
+#include <array>
+#include <bit>
+#include <random>
+#include <type_traits>
+
+/*
+========================================================================================================================
+- - Macros - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Engine used by D_Map, any engine with 32 bit output and a seed(uint64_t), or std::mt19937. Changing
+ * the engine changes the design each seed produces.
+ **********************************************************************************************************************/
+#ifndef D_MAP_RNG_ENGINE
+#define D_MAP_RNG_ENGINE D_Xoshiro128ss
+#endif
+
+/*
+========================================================================================================================
+- - Functions - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Steps a SplitMix64 state, used to expand a single 64 bit seed into engine state.
+ *
+ * @param[inout] state SplitMix64 state to step.
+ *
+ * @retval uint64_t Next output of the SplitMix64 sequence.
+ **********************************************************************************************************************/
+inline uint64_t splitmix64(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/***********************************************************************************************************************
+ * @brief Rolls a uniform random number in [0, bound) with Lemire's multiply-shift method, a division is only needed on
+ * the rare roll that lands in the biased range.
+ *
+ * @param[inout] engine Engine with a uint32_t result_type to draw from.
+ * @param[in] bound Exclusive upper bound, must be non zero.
+ *
+ * @retval uint32_t The rolled number.
+ **********************************************************************************************************************/
+template <typename Engine>
+inline uint32_t bounded_roll(Engine &engine, uint32_t bound)
+{
+    static_assert(Engine::min() == 0 && Engine::max() == UINT32_MAX, "bounded_roll needs an engine with 32 bit output");
+
+    uint64_t product = static_cast<uint64_t>(static_cast<uint32_t>(engine())) * bound;
+    uint32_t low = static_cast<uint32_t>(product);
+    if (low < bound)
+    {
+        uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+        while (low < threshold)
+        {
+            product = static_cast<uint64_t>(static_cast<uint32_t>(engine())) * bound;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+/*
+========================================================================================================================
+- - Start of D_Xoshiro128ss Class - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief xoshiro128** engine, 16 bytes of state and a handful of shifts and rotates per output.
+ *
+ * @members :
+ *      @private std::array<uint32_t, 4> state = Engine state, never all zero.
+ **********************************************************************************************************************/
+class D_Xoshiro128ss
+{
+public:
+    using result_type = uint32_t;
+
+    explicit D_Xoshiro128ss(uint64_t in_seed = 0) { seed(in_seed); }
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    void seed(uint64_t in_seed)
+    {
+        uint64_t split_state = in_seed;
+        uint64_t first = splitmix64(split_state);
+        uint64_t second = splitmix64(split_state);
+        state = {static_cast<uint32_t>(first), static_cast<uint32_t>(first >> 32),
+                 static_cast<uint32_t>(second), static_cast<uint32_t>(second >> 32)};
+    }
+
+    result_type operator()()
+    {
+        uint32_t result = std::rotl(state[1] * 5, 7) * 9;
+        uint32_t shifted = state[1] << 9;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= shifted;
+        state[3] = std::rotl(state[3], 11);
+        return result;
+    }
+
+private:
+    std::array<uint32_t, 4> state;
+};
+
+/*
+========================================================================================================================
+- - Start of D_Pcg32 Class - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief PCG32 (XSH RR) engine, 16 bytes of state and one 64 bit multiply per output.
+ *
+ * @members :
+ *      @private uint64_t state = LCG state.
+ *      @private uint64_t increment = LCG increment, always odd, selects the stream.
+ **********************************************************************************************************************/
+class D_Pcg32
+{
+public:
+    using result_type = uint32_t;
+
+    explicit D_Pcg32(uint64_t in_seed = 0) { seed(in_seed); }
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+
+    void seed(uint64_t in_seed)
+    {
+        uint64_t split_state = in_seed;
+        increment = (splitmix64(split_state) << 1) | 1;
+        state = 0;
+        (*this)();
+        state += splitmix64(split_state);
+        (*this)();
+    }
+
+    result_type operator()()
+    {
+        uint64_t old_state = state;
+        state = old_state * 6364136223846793005ULL + increment;
+        uint32_t xor_shifted = static_cast<uint32_t>(((old_state >> 18) ^ old_state) >> 27);
+        int rotation = static_cast<int>(old_state >> 59);
+        return std::rotr(xor_shifted, rotation);
+    }
+
+private:
+    uint64_t state;
+    uint64_t increment;
+};
+
+/*
+========================================================================================================================
+- - Aliases - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Engine used by D_Map, @see D_MAP_RNG_ENGINE.
+ **********************************************************************************************************************/
+using D_Map_Rng = D_MAP_RNG_ENGINE;
+
+/***********************************************************************************************************************
+ * @brief Seeds an engine from a 64 bit seed.
+ *
+ * @param[inout] engine Engine to seed.
+ * @param[in] in_seed Seed to use.
+ *
+ * @note std::mt19937 is seeded through std::seed_seq, whose algorithm is fixed by the standard.
+ **********************************************************************************************************************/
+template <typename Engine>
+inline void seed_engine(Engine &engine, uint64_t in_seed)
+{
+    if constexpr (std::is_same_v<Engine, std::mt19937>)
+    {
+        std::seed_seq seed_sequence{static_cast<uint32_t>(in_seed), static_cast<uint32_t>(in_seed >> 32)};
+        engine.seed(seed_sequence);
+    }
+    else
+    {
+        engine.seed(in_seed);
+    }
+}
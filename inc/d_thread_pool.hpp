@@ -0,0 +1,93 @@
+/***********************************************************************************************************************
+ * @date 2026-10-16
+ * @author Gregory Nitch
+ *
+ * @brief Header for the D_Thread_Pool class, a persistent work-stealing pool of worker threads used for batch map
+ * generation. For documentation for each function @see d_thread_pool.cpp.
+ **********************************************************************************************************************/
+
+#pragma once
+
+/*
+========================================================================================================================
+- - System Includes - -
+========================================================================================================================
+*/
+
+#include <cstdint>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+========================================================================================================================
+- - Start of D_Thread_Pool Class - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief A persistent pool of worker threads. Each run() splits its jobs into one contiguous range per worker, workers
+ * take jobs from the front of their own queue and, once it is empty, steal from the back of another worker's queue so
+ * uneven jobs still balance across every core.
+ *
+ * @members :
+ *      @private std::vector<std::unique_ptr<Worker_Queue>> queues = Job queue of each worker.
+ *      @private std::vector<std::thread> threads = Worker threads, one per queue.
+ *      @private std::mutex run_mtx = Serializes calls to run().
+ *      @private std::mutex state_mtx = Guards the run state below and backs both condition variables.
+ *      @private std::condition_variable work_cv = Wakes workers when a run starts or the pool stops.
+ *      @private std::condition_variable done_cv = Wakes run() when the last job finishes and workers go idle.
+ *      @private std::function<void(size_t, size_t)> const *current_job = Job of the current run, nullptr when idle.
+ *      @private uint64_t run_count = Incremented for each run so workers can tell a new run from a spurious wake.
+ *      @private size_t active_workers = Workers currently taking jobs from the queues.
+ *      @private std::atomic<size_t> remaining_jobs = Jobs of the current run that have not finished.
+ *      @private std::atomic<bool> cancelled = Set when a job throws, remaining jobs are skipped.
+ *      @private std::exception_ptr job_exception = First exception thrown by a job in the current run.
+ *      @private bool stopping = Set on destruction to stop the workers.
+ *      @private static thread_local D_Thread_Pool *worker_pool = Pool the calling thread is a worker of, if any.
+ *      @private static thread_local size_t worker_index = Index of the calling thread within worker_pool.
+ **********************************************************************************************************************/
+class D_Thread_Pool
+{
+public:
+    explicit D_Thread_Pool(size_t thread_count);
+    ~D_Thread_Pool();
+    D_Thread_Pool(D_Thread_Pool const &) = delete;
+    D_Thread_Pool &operator=(D_Thread_Pool const &) = delete;
+    size_t size() const;
+    void run(size_t job_count, std::function<void(size_t job_idx, size_t worker_idx)> const &job);
+    static D_Thread_Pool &shared();
+
+private:
+    struct Worker_Queue
+    {
+        std::deque<size_t> jobs;
+        std::mutex mtx;
+    };
+
+    std::vector<std::unique_ptr<Worker_Queue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex run_mtx;
+    std::mutex state_mtx;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    std::function<void(size_t, size_t)> const *current_job = nullptr;
+    uint64_t run_count = 0;
+    size_t active_workers = 0;
+    std::atomic<size_t> remaining_jobs = 0;
+    std::atomic<bool> cancelled = false;
+    std::exception_ptr job_exception = nullptr;
+    bool stopping = false;
+
+    static thread_local D_Thread_Pool *worker_pool;
+    static thread_local size_t worker_index;
+
+    void worker_loop(size_t worker_idx);
+    bool take_job(size_t worker_idx, size_t &job_idx);
+};
@@ -22,6 +22,7 @@
 #include <array>
 #include <filesystem>
 #include <atomic>
+#include <mutex>
 
 /*
 ========================================================================================================================
@@ -76,6 +77,18 @@
  **********************************************************************************************************************/
 #define SIDE_LAST_BIT_MASK (0x80)
 
+/***********************************************************************************************************************
+ * @brief Pixel format every tile image is converted to when decoded, maps composite into this format so tile scanlines
+ * can be copied without conversion.
+ **********************************************************************************************************************/
+#define TILE_IMAGE_FORMAT (QImage::Format_ARGB32)
+
+/***********************************************************************************************************************
+ * @brief Image level of a tile's preview, ie previews are 1/2^level of the full size. Level 3 (1/8) lets JPEG tiles be
+ * decoded straight at preview size. @see D_Tile::get_image_level()
+ **********************************************************************************************************************/
+#define TILE_PREVIEW_LEVEL (3)
+
 /*
 ========================================================================================================================
 - - Start of Connection_Rotations Enum - -
@@ -121,6 +134,28 @@ constexpr std::array<uint32_t, 4> CONNECTION_SIDE_MASKS = {
     0x00FF0000,  // Bottom
     0xFF000000}; // Left
 
+/*
+========================================================================================================================
+- - Start of Image_Load_Mode Enum - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Represents when a tile's image is decoded when loading tiles.
+ *
+ * @remarks Values:
+ *      Eager = 0, Images are decoded while loading.
+ *      Lazy = 1, Only metadata is loaded, images are decoded on first use. @see D_Tile::get_image()
+ *      Preview = 2, Only a preview of each image is decoded while loading, at reduced size so JPEGs skip most of their
+ *                decode, full images are decoded on first use. For map previews. @see D_Map::render_preview()
+ **********************************************************************************************************************/
+enum class Image_Load_Mode
+{
+    Eager = 0,
+    Lazy = 1,
+    Preview = 2,
+};
+
 /*
 ========================================================================================================================
 - - Start of D_Connection Union - -
@@ -304,7 +339,8 @@ std::unordered_map<uint32_t, std::string> const Connection_Bit_Mask_to_Str_Map =
  * @brief Represents a possbile section in the D_Map object.
  *
  * @members :
- *      @private QImage The actual image object used for the tile instance.
+ *      @private QImage The actual image object used for the tile instance. For permutations this is built from the base
+ *               tile's image on first use, for lazily loaded tiles it is decoded on first use.
  *      @private std::filesystem::path path = Path to the actual image.
  *      @private std::string name = Name of the section.
  *      @private std::string theme = Theme of the section.
@@ -318,6 +354,19 @@ std::unordered_map<uint32_t, std::string> const Connection_Bit_Mask_to_Str_Map =
  *      @private Connection_Rotations rotation_amount = The amount that this tile's image needs to be rotated when
  *               generating its image. @note This is set to zero for tiles that have not been permutated or those that
  *               have been flipped.
+ *      @private std::shared_ptr<D_Tile> base_tile = The tile this permutation was made from, its image is shared and
+ *               transformed on draw. Null for tiles that are not permutations.
+ *      @private std::once_flag image_flag = Guards the one time decode or build of the tile's image.
+ *      @private std::atomic<bool> is_solid_flag = Whether or not every pixel of the tile's image is the same, set with
+ *               the image. Atomic so previews can check it without waiting on the full image.
+ *      @private QRgb solid_pixel = The pixel filling the image when is_solid_flag is set.
+ *      @private std::vector<QImage> image_levels = Downsampled copies of the image, each half the size of the one before,
+ *               from level 1 up to the level before TILE_PREVIEW_LEVEL. Built on first use. @see get_image_level()
+ *      @private std::once_flag levels_flag = Guards the one time build of image_levels.
+ *      @private QImage preview_image = Preview decoded while loading with Image_Load_Mode::Preview, null otherwise.
+ *      @private std::vector<QImage> preview_levels = The image at TILE_PREVIEW_LEVEL and each half size level after it
+ *               down to 1x1. Built on first use from preview_image, the base tile's preview or image_levels.
+ *      @private std::once_flag preview_flag = Guards the one time build of preview_levels.
  *
  *      //! NOTE: May be replaced later with id set by a database.
  *      @private static std::atomic<uint64_t> id_counter = Static class varible used to assign IDs to loaded and generate tiles.
@@ -327,13 +376,25 @@ class D_Tile
 public:
     D_Tile(std::filesystem::path const &path);
     ~D_Tile();
-    static void load_tiles(std::filesystem::path const &dir_path, std::filesystem::path const &loaded_path = "");
-    static void generate_tiles();
+    static void load_tiles(std::filesystem::path const &dir_path,
+                           std::filesystem::path const &loaded_path = "",
+                           Image_Load_Mode load_mode = Image_Load_Mode::Eager);
+    static bool sync_loaded_tiles(std::filesystem::path const &dir_path,
+                                  std::filesystem::path const &loaded_path,
+                                  std::filesystem::path const &cache_path);
+    static void generate_tiles(std::filesystem::path const &manifest_path = "");
+    static bool load_manifest(std::filesystem::path const &manifest_path,
+                              Image_Load_Mode load_mode = Image_Load_Mode::Lazy);
     std::string const &get_name() const;
     std::string const &get_theme() const;
     uint64_t get_id() const;
     D_Connections get_connections() const;
     std::shared_ptr<QImage> const &get_image();
+    bool is_solid() const;
+    QRgb get_solid_pixel() const;
+    QImage const &get_image_level(size_t level);
+    size_t get_level_count();
+    static QImage downsample(QImage const &image);
     bool is_permutateable() const;
     bool is_entrance() const;
     bool is_exit() const;
@@ -356,10 +417,20 @@ private:
     bool is_flippable_flag;
     bool is_flipped_flag = false;
     Connection_Rotations rotation_amount = Connection_Rotations::Zero;
+    std::shared_ptr<D_Tile> base_tile = nullptr;
+    std::once_flag image_flag;
+    std::atomic<bool> is_solid_flag = false;
+    QRgb solid_pixel = 0;
+    std::vector<QImage> image_levels;
+    std::once_flag levels_flag;
+    QImage preview_image;
+    std::vector<QImage> preview_levels;
+    std::once_flag preview_flag;
 
     //! NOTE: May be replaced later with id set by a database.
     static std::atomic<uint64_t> id_counter;
 
+    D_Tile(std::filesystem::path const &in_path, uint64_t in_id);
     D_Tile(std::string permutation_name,
            std::string permutation_theme,
            uint64_t permutation_id,
@@ -373,9 +444,13 @@ private:
                                  std::vector<std::shared_ptr<D_Tile>> &permutations,
                                  size_t &entrance_count,
                                  size_t &exit_count);
-    inline std::string const to_filename();
-    bool generate_tile_img();
+    QImage transform_image(QImage const &base_image) const;
+    void set_image(std::shared_ptr<QImage> in_image);
+    QImage decode_preview() const;
     void copy_tile_img(std::filesystem::path loaded_dir);
+    static void save_manifest(std::filesystem::path const &manifest_path);
+    static uint64_t stamp_directory(std::filesystem::path const &dir_path);
+    static uint64_t hash_tile_file(std::filesystem::path const &file_path);
     static inline D_Connections rotate_connections(Connection_Rotations rotation, D_Connections to_rotate);
     static inline D_Connections flip_connections(D_Connections to_flip);
 };
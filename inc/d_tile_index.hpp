@@ -0,0 +1,152 @@
+/***********************************************************************************************************************
+ * @date 2026-10-16
+ * @author Gregory Nitch
+ *
+ * @brief Header for the D_Tile_Index class, a prebuilt connection index over a set of D_Tiles used to select tile
+ * canidates during map generation. For documentation for each function @see d_tile_index.cpp.
+ **********************************************************************************************************************/
+
+#pragma once
+
+/*
+========================================================================================================================
+- - System Includes - -
+========================================================================================================================
+*/
+
+#include <cstdint>
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/*
+========================================================================================================================
+- - Local Includes - -
+========================================================================================================================
+*/
+
+#include "d_tile.hpp"
+
+/*
+========================================================================================================================
+- - Macros - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Number of connection bits in a D_Connections mask, ie one index bitset per connection.
+ **********************************************************************************************************************/
+#define TILE_INDEX_CONNECTION_BITS (32)
+
+/***********************************************************************************************************************
+ * @brief Number of tile slots held in one word of a tile index bitset.
+ **********************************************************************************************************************/
+#define TILE_INDEX_WORD_BITS (64)
+
+/***********************************************************************************************************************
+ * @brief Number of distinct connection patterns one side of a tile can have, ie one per 8 bit side mask.
+ **********************************************************************************************************************/
+#define TILE_INDEX_SIDE_PATTERNS (256)
+
+/***********************************************************************************************************************
+ * @brief Side pattern lookup value of a pattern no slot has on that side.
+ **********************************************************************************************************************/
+#define TILE_INDEX_NO_PATTERN (UINT16_MAX)
+
+/*
+========================================================================================================================
+- - Start of D_Tile_Set Enum - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief The base set of tiles a D_Tile_Index query is filtered from.
+ *
+ * @remarks Values:
+ *      All = Every tile in the index,
+ *      Entrances = Only entrance tiles,
+ **********************************************************************************************************************/
+enum class D_Tile_Set
+{
+    All = 0,
+    Entrances = 1,
+};
+
+/*
+========================================================================================================================
+- - Start of D_Tile_Index Class - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief An immutable connection index over a map of D_Tiles. Each tile is given a slot (ordered by tile id) and each
+ * connection bit has a bitset over those slots, canidate queries are then answered by intersecting bitsets a word at a
+ * time instead of scanning every tile. Constraint solving uses domain bitsets, which add one virtual empty slot after
+ * the last tile slot to stand for the Empty_Tile, ie a slot with no connections.
+ *
+ * @members :
+ *      @private size_t word_count = Number of uint64_t words needed to hold one bit per slot.
+ *      @private std::vector<std::shared_ptr<D_Tile>> owners = Indexed tiles, ordered by id. Only held so the tiles live
+ *               as long as the index, lookups go through slots so no reference count is touched while generating.
+ *      @private std::vector<D_Tile *> slots = Arena of the indexed tiles, ie owners without the reference counts.
+ *      @private std::vector<D_Connections> slot_connections = Connections of each slot, kept flat so generation can read
+ *               neighboor connections without touching the tiles themselves.
+ *      @private std::vector<D_Connections> slot_facing_connections = Connections of each slot with every side reversed,
+ *               ie as a neighboor facing that side sees them.
+ *      @private std::vector<uint64_t> connection_words = Per word, one bitset word for each connection bit, ie laid
+ *               out as [word][connection bit] so a query walks memory linearly.
+ *      @private std::vector<uint64_t> all_words = Bitset of every valid slot.
+ *      @private std::vector<uint64_t> entrance_words = Bitset of every entrance slot.
+ *      @private size_t domain_word_count = Number of words in a domain bitset, ie one bit per slot plus the empty slot.
+ *      @private std::array<std::vector<uint8_t>, 4> side_patterns = Per side, each distinct pattern found on that side.
+ *      @private std::array<std::array<uint16_t, TILE_INDEX_SIDE_PATTERNS>, 4> side_pattern_lookup = Per side, the
+ *               position of a pattern in side_patterns or TILE_INDEX_NO_PATTERN.
+ *      @private std::array<std::vector<uint64_t>, 4> side_pattern_words = Per side, a domain bitset for each distinct
+ *               pattern of every slot (and the empty slot) with exactly that pattern on that side, laid out as
+ *               [pattern][word].
+ *      @private std::vector<std::array<uint16_t, 4>> compatible_patterns = Per slot (and the empty slot) and side, the
+ *               position in side_patterns of the mirrored side's matching pattern, ie the neighboors that slot accepts.
+ *      @private std::vector<uint64_t> no_domain_words = Empty domain bitset, returned when a side accepts no neighboor.
+ *      @private uint64_t hash = Hash of the indexed tile set, @see get_hash().
+ **********************************************************************************************************************/
+class D_Tile_Index
+{
+public:
+    D_Tile_Index(std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> const &tile_map);
+    size_t size() const;
+    uint64_t get_hash() const;
+    size_t get_word_count() const;
+    D_Tile *get_tile(size_t slot) const;
+    D_Connections get_connections(size_t slot) const;
+    D_Connections get_facing_connections(size_t slot) const;
+    size_t find_slot(uint64_t id) const;
+    size_t filter(D_Tile_Set tile_set,
+                  uint32_t required_mask,
+                  uint32_t allowed_mask,
+                  D_Connections side_requirements,
+                  std::vector<uint64_t> &canidate_words) const;
+    size_t nth_canidate(std::vector<uint64_t> const &canidate_words, size_t n) const;
+    size_t get_empty_slot() const;
+    size_t get_domain_word_count() const;
+    uint64_t const *side_pattern_domain(size_t side, uint8_t pattern) const;
+    void side_support(size_t side, uint64_t const *neighboor_domain, uint64_t *support_words) const;
+    uint64_t const *compatible_domain(size_t slot, size_t side) const;
+
+private:
+    size_t word_count;
+    std::vector<std::shared_ptr<D_Tile>> owners;
+    std::vector<D_Tile *> slots;
+    std::vector<D_Connections> slot_connections;
+    std::vector<D_Connections> slot_facing_connections;
+    std::vector<uint64_t> connection_words;
+    std::vector<uint64_t> all_words;
+    std::vector<uint64_t> entrance_words;
+    size_t domain_word_count;
+    std::array<std::vector<uint8_t>, 4> side_patterns;
+    std::array<std::array<uint16_t, TILE_INDEX_SIDE_PATTERNS>, 4> side_pattern_lookup;
+    std::array<std::vector<uint64_t>, 4> side_pattern_words;
+    std::vector<std::array<uint16_t, 4>> compatible_patterns;
+    std::vector<uint64_t> no_domain_words;
+    uint64_t hash;
+};
@@ -0,0 +1,670 @@
+/***********************************************************************************************************************
+ * @date 2026-10-16
+ * @author Gregory Nitch
+ *
+ * @brief Application benchmarks, times map generation over increasing map sizes so scaling can be checked against the
+ * cell count, compares the random number engines generation can be built with and times map compositing, previews and
+ * encoding. Not run by ctest, run D_Benchmark directly.
+ **********************************************************************************************************************/
+
+/*
+========================================================================================================================
+- - System Includes - -
+========================================================================================================================
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <format>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <random>
+
+/*
+========================================================================================================================
+- - 3rd Party Includes - -
+========================================================================================================================
+*/
+
+#include <QImage>
+#include <QPainter>
+
+/*
+========================================================================================================================
+- - Local Includes - -
+========================================================================================================================
+*/
+
+#include "d_map.hpp"
+#include "d_tile.hpp"
+#include "d_tile_index.hpp"
+#include "d_random.hpp"
+#include "d_builder_common.hpp"
+
+/*
+========================================================================================================================
+- - Macros - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Default largest map size benchmarked, in both width and height.
+ **********************************************************************************************************************/
+#define DEFAULT_BENCHMARK_MAX_MAP_SIZE (1024)
+
+/***********************************************************************************************************************
+ * @brief Smallest map size benchmarked, sizes double from here up to the max size.
+ **********************************************************************************************************************/
+#define BENCHMARK_MIN_MAP_SIZE (32)
+
+/***********************************************************************************************************************
+ * @brief Number of cells generated at each map size, the repetitions at a size are this divided by its cell count.
+ **********************************************************************************************************************/
+#define BENCHMARK_CELLS_PER_SIZE (4 * 1024 * 1024)
+
+/***********************************************************************************************************************
+ * @brief Connection chance used for benchmarked maps, kept low enough that large maps rarely hit a dead end.
+ **********************************************************************************************************************/
+#define BENCHMARK_CONNECTION_CHANCE (40)
+
+/***********************************************************************************************************************
+ * @brief Number of bounded rolls timed for each random number engine.
+ **********************************************************************************************************************/
+#define BENCHMARK_RNG_ROLLS (1 << 24)
+
+/***********************************************************************************************************************
+ * @brief Width and height of the region regenerated on each map size.
+ **********************************************************************************************************************/
+#define BENCHMARK_REGION_SIZE (16)
+
+/***********************************************************************************************************************
+ * @brief Number of regions regenerated on each map size.
+ **********************************************************************************************************************/
+#define BENCHMARK_REGION_REPS (256)
+
+/***********************************************************************************************************************
+ * @brief Largest map size composited, in both width and height. Tiles are large images, so canvases grow quickly.
+ **********************************************************************************************************************/
+#define BENCHMARK_RENDER_MAX_MAP_SIZE (8)
+
+/***********************************************************************************************************************
+ * @brief Number of times each map size is composited by each method.
+ **********************************************************************************************************************/
+#define BENCHMARK_RENDER_REPS (16)
+
+/***********************************************************************************************************************
+ * @brief Width and height of the maps previews are timed on, ie a map picker thumbnail.
+ **********************************************************************************************************************/
+#define BENCHMARK_PREVIEW_MAP_SIZE (20)
+
+/***********************************************************************************************************************
+ * @brief Number of maps rendered both in full and as previews.
+ **********************************************************************************************************************/
+#define BENCHMARK_PREVIEW_MAPS (16)
+
+/***********************************************************************************************************************
+ * @brief Width and height of the map each output encoder is timed on.
+ **********************************************************************************************************************/
+#define BENCHMARK_ENCODE_MAP_SIZE (16)
+
+/***********************************************************************************************************************
+ * @brief Number of times each output encoder is timed.
+ **********************************************************************************************************************/
+#define BENCHMARK_ENCODE_REPS (4)
+
+/***********************************************************************************************************************
+ * @brief Number of times each map layout is encoded and decoded.
+ **********************************************************************************************************************/
+#define BENCHMARK_LAYOUT_REPS (16)
+
+/*
+========================================================================================================================
+- - Global Variable INIT - -
+========================================================================================================================
+*/
+
+std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> Tile_Map = {};
+std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> Entrance_Map = {};
+std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> Exit_Map = {};
+std::shared_ptr<D_Tile> Empty_Tile = nullptr;
+std::shared_ptr<D_Tile_Index const> Tile_Index = nullptr;
+std::unique_ptr<D_Map> Dungeon_Map = nullptr;
+
+/*
+========================================================================================================================
+- - Main Start - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Times D_Map::generate() at a given map size. Generations that hit a dead end are counted but not timed.
+ *
+ * @param[in] size Width and height of the map.
+ * @param[in] mode Generation mode to time.
+ *
+ * @retval double Average nanoseconds per generated cell, 0 if every generation hit a dead end.
+ **********************************************************************************************************************/
+double benchmark_generation(uint16_t size, Generation_Mode mode)
+{
+    size_t cells = static_cast<size_t>(size) * size;
+    size_t reps = std::max<size_t>(1, BENCHMARK_CELLS_PER_SIZE / cells);
+    size_t failures = 0;
+    double total_ns = 0;
+
+    // Keep per map debug logging out of the timings output.
+    Log_Level log_level = D_Logger::get_level();
+    D_Logger::set_level(Log_Level::Warn);
+
+    std::unique_ptr<D_Map> d_map = nullptr;
+    for (size_t rep = 0; rep < reps; rep++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        try
+        {
+            if (!d_map)
+            {
+                // Build from a Propagate layout, a constructor generating in the Greedy mode could hit a dead end.
+                std::vector<D_Map_Layout> layouts = D_Map::generate_batch(1, size, size, BENCHMARK_CONNECTION_CHANCE,
+                                                                          rep, Tile_Map, Generation_Mode::Propagate);
+                d_map = std::make_unique<D_Map>(layouts.front());
+                d_map->set_generation_mode(mode);
+                start = std::chrono::steady_clock::now();
+            }
+            d_map->generate();
+        }
+        catch (std::runtime_error const &)
+        {
+            failures++;
+            continue;
+        }
+        auto end = std::chrono::steady_clock::now();
+        total_ns += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    D_Logger::set_level(log_level);
+
+    size_t successes = reps - failures;
+    double ns_per_cell = successes ? total_ns / static_cast<double>(cells * successes) : 0;
+    std::cout << std::format("{:<10} {:>5}x{:<5} reps:{:>5} dead ends:{:>5} ms/map:{:>10.3f} ns/cell:{:>8.1f}",
+                             Generation_Mode::Greedy == mode ? "Greedy" : "Propagate",
+                             size,
+                             size,
+                             reps,
+                             failures,
+                             successes ? total_ns / static_cast<double>(successes) / 1e6 : 0,
+                             ns_per_cell)
+              << std::endl;
+    return ns_per_cell;
+}
+
+/***********************************************************************************************************************
+ * @brief Times D_Map::regenerate_region() for a fixed size region at random points of a map, the time should stay flat
+ * as the map grows. Regions that cannot be solved are counted but not timed.
+ *
+ * @param[in] size Width and height of the map, at least BENCHMARK_REGION_SIZE.
+ *
+ * @retval double Average microseconds per region, 0 if every region failed.
+ **********************************************************************************************************************/
+double benchmark_region(uint16_t size)
+{
+    Log_Level log_level = D_Logger::get_level();
+    D_Logger::set_level(Log_Level::Warn);
+
+    std::vector<D_Map_Layout> layouts = D_Map::generate_batch(1, size, size, BENCHMARK_CONNECTION_CHANCE, size,
+                                                              Tile_Map, Generation_Mode::Propagate);
+    D_Map d_map(layouts.front());
+    D_Xoshiro128ss engine(size);
+    size_t failures = 0;
+    double total_ns = 0;
+    for (size_t rep = 0; rep < BENCHMARK_REGION_REPS; rep++)
+    {
+        uint16_t col = static_cast<uint16_t>(bounded_roll(engine, size - BENCHMARK_REGION_SIZE + 1U));
+        uint16_t row = static_cast<uint16_t>(bounded_roll(engine, size - BENCHMARK_REGION_SIZE + 1U));
+        auto start = std::chrono::steady_clock::now();
+        try
+        {
+            d_map.regenerate_region(col, row, col + BENCHMARK_REGION_SIZE - 1, row + BENCHMARK_REGION_SIZE - 1);
+        }
+        catch (std::runtime_error const &)
+        {
+            failures++;
+            continue;
+        }
+        auto end = std::chrono::steady_clock::now();
+        total_ns += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    D_Logger::set_level(log_level);
+
+    size_t successes = BENCHMARK_REGION_REPS - failures;
+    double us_per_region = successes ? total_ns / static_cast<double>(successes) / 1e3 : 0;
+    std::cout << std::format("Region {}x{} on {:>5}x{:<5} failures:{:>5} us/region:{:>10.1f}",
+                             BENCHMARK_REGION_SIZE,
+                             BENCHMARK_REGION_SIZE,
+                             size,
+                             size,
+                             failures,
+                             us_per_region)
+              << std::endl;
+    return us_per_region;
+}
+
+/***********************************************************************************************************************
+ * @brief Composites a map design the way D_Map::save() used to, QPainter::drawImage() per tile onto a transparent canvas,
+ * as the reference D_Map::render() is compared against.
+ *
+ * @param[in] d_map Map to composite.
+ *
+ * @retval QImage The composited design.
+ **********************************************************************************************************************/
+QImage painter_composite(D_Map const &d_map)
+{
+    int width = 0;
+    int height = 0;
+    for (uint16_t col = 0; col < d_map.get_cols(); col++)
+        width += d_map.get_tile(col, 0)->get_image()->width();
+    for (uint16_t row = 0; row < d_map.get_rows(); row++)
+        height += d_map.get_tile(0, row)->get_image()->height();
+
+    QImage result(width, height, QImage::Format_ARGB32);
+    result.fill(Qt::transparent);
+    QPainter painter(&result);
+    int current_y = 0;
+    for (uint16_t row = 0; row < d_map.get_rows(); row++)
+    {
+        int current_x = 0;
+        for (uint16_t col = 0; col < d_map.get_cols(); col++)
+        {
+            std::shared_ptr<QImage> const &image = d_map.get_tile(col, row)->get_image();
+            painter.drawImage(current_x, current_y, *image);
+            current_x += image->width();
+        }
+        current_y += d_map.get_tile(0, row)->get_image()->height();
+    }
+    painter.end();
+    return result;
+}
+
+/***********************************************************************************************************************
+ * @brief Times compositing a map design with QPainter against D_Map::render()'s scanline compositor, both for a full
+ * canvas and for re-rendering after a single swapped tile. Tile images are decoded before timing.
+ *
+ * @param[in] size Width and height of the map.
+ **********************************************************************************************************************/
+void benchmark_render(uint16_t size)
+{
+    Log_Level log_level = D_Logger::get_level();
+    D_Logger::set_level(Log_Level::Warn);
+
+    std::vector<D_Map_Layout> layouts = D_Map::generate_batch(1, size, size, BENCHMARK_CONNECTION_CHANCE, size,
+                                                              Tile_Map, Generation_Mode::Propagate);
+    D_Map d_map(layouts.front());
+    QImage const &canvas = d_map.render(); // Decodes every tile image used
+    double canvas_mb = static_cast<double>(canvas.sizeInBytes()) / (1024.0 * 1024.0);
+
+    double painter_ns = 0;
+    double blit_ns = 0;
+    double swap_ns = 0;
+    for (size_t rep = 0; rep < BENCHMARK_RENDER_REPS; rep++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        [[maybe_unused]] QImage painted = painter_composite(d_map);
+        auto end = std::chrono::steady_clock::now();
+        painter_ns += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+
+        D_Map fresh(layouts.front());
+        start = std::chrono::steady_clock::now();
+        fresh.render();
+        end = std::chrono::steady_clock::now();
+        blit_ns += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+
+        uint16_t col = static_cast<uint16_t>(rep % size);
+        uint16_t row = static_cast<uint16_t>(rep / size % size);
+        fresh.swap_tile(col, row, MAP_EMPTY_TILE_HANDLE == fresh.get_tile_grid()[static_cast<size_t>(row) * size + col]
+                                      ? Tile_Map.begin()->second
+                                      : Empty_Tile);
+        start = std::chrono::steady_clock::now();
+        fresh.render();
+        end = std::chrono::steady_clock::now();
+        swap_ns += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    for (auto [name, total_ns] : {std::pair<char const *, double>{"QPainter", painter_ns},
+                                  std::pair<char const *, double>{"Scanline", blit_ns}})
+    {
+        double ms = total_ns / BENCHMARK_RENDER_REPS / 1e6;
+        std::cout << std::format("{:<10} {:>3}x{:<3} canvas:{:>8.1f}MB ms/map:{:>10.3f} MB/s:{:>10.1f}",
+                                 name,
+                                 size,
+                                 size,
+                                 canvas_mb,
+                                 ms,
+                                 ms > 0 ? canvas_mb / (ms / 1e3) : 0)
+                  << std::endl;
+    }
+    std::cout << std::format("Scanline after one swap_tile ms/map:{:>10.3f}", swap_ns / BENCHMARK_RENDER_REPS / 1e6)
+              << std::endl;
+
+    // Composites and encodes together, a row of tiles at a time.
+    std::filesystem::path out_path = std::filesystem::temp_directory_path() / "d_benchmark_render_streamed.ppm";
+    auto start = std::chrono::steady_clock::now();
+    bool saved = d_map.save_streamed(out_path.string());
+    auto end = std::chrono::steady_clock::now();
+    double ms = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / 1e6;
+    std::cout << std::format("Save streamed .ppm {:>3}x{:<3} ms:{:>10.3f} MB/s:{:>10.1f} strip:{:>8.1f}MB{}",
+                             size,
+                             size,
+                             ms,
+                             ms > 0 ? canvas_mb / (ms / 1e3) : 0,
+                             canvas_mb / size,
+                             saved ? "" : " (failed)")
+              << std::endl;
+    std::filesystem::remove(out_path);
+
+    D_Logger::set_level(log_level);
+}
+
+/***********************************************************************************************************************
+ * @brief Times rendering a batch of maps in full against rendering them as previews. The first preview pass includes
+ * building each tile's levels, later passes reuse them as a map picker would.
+ *
+ * @param[in] size Width and height of the maps.
+ **********************************************************************************************************************/
+void benchmark_preview(uint16_t size)
+{
+    Log_Level log_level = D_Logger::get_level();
+    D_Logger::set_level(Log_Level::Warn);
+
+    std::vector<D_Map_Layout> layouts = D_Map::generate_batch(BENCHMARK_PREVIEW_MAPS, size, size,
+                                                              BENCHMARK_CONNECTION_CHANCE, size, Tile_Map,
+                                                              Generation_Mode::Propagate);
+    auto time_maps = [&](auto render_map)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (D_Map_Layout const &layout : layouts)
+        {
+            D_Map d_map(layout);
+            render_map(d_map);
+        }
+        auto end = std::chrono::steady_clock::now();
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) /
+               static_cast<double>(layouts.size()) / 1e6;
+    };
+    double full_ms = time_maps([](D_Map &d_map)
+                               { d_map.render(); });
+    double first_preview_ms = time_maps([](D_Map &d_map)
+                                        { d_map.render_preview(); });
+    double preview_ms = time_maps([](D_Map &d_map)
+                                  { d_map.render_preview(); });
+
+    D_Logger::set_level(log_level);
+
+    std::cout << std::format("{:>3}x{:<3} ms/map full:{:>10.3f} first preview:{:>10.3f} preview:{:>10.3f} "
+                             "(1/{} scale, {:.1f}x faster)",
+                             size,
+                             size,
+                             full_ms,
+                             first_preview_ms,
+                             preview_ms,
+                             1 << TILE_PREVIEW_LEVEL,
+                             preview_ms > 0 ? full_ms / preview_ms : 0)
+              << std::endl;
+}
+
+/***********************************************************************************************************************
+ * @brief Times each output encoder on one map, printing encode throughput over the raw canvas and the file size.
+ *
+ * @param[in] size Width and height of the map encoded.
+ **********************************************************************************************************************/
+void benchmark_encoders(uint16_t size)
+{
+    Log_Level log_level = D_Logger::get_level();
+    D_Logger::set_level(Log_Level::Warn);
+
+    std::vector<D_Map_Layout> layouts = D_Map::generate_batch(1, size, size, BENCHMARK_CONNECTION_CHANCE, size,
+                                                              Tile_Map, Generation_Mode::Propagate);
+    D_Map d_map(layouts.front());
+    QImage const &canvas = d_map.render(); // Encoding only from here on
+    double canvas_mb = static_cast<double>(canvas.sizeInBytes()) / (1024.0 * 1024.0);
+
+    struct Encoder_Run
+    {
+        char const *name;
+        char const *extension;
+        Image_Encoder encoder;
+        int setting;
+    };
+    constexpr std::array<Encoder_Run, 8> runs = {{
+        {"JPEG q100", ".jpg", Image_Encoder::Jpeg, 100},
+        {"JPEG q90", ".jpg", Image_Encoder::Jpeg, 90},
+        {"PNG z0", ".png", Image_Encoder::Png, 0},
+        {"PNG z1", ".png", Image_Encoder::Png, 1},
+        {"PNG z6", ".png", Image_Encoder::Png, 6},
+        {"PNG z9", ".png", Image_Encoder::Png, 9},
+        {"PPM", ".ppm", Image_Encoder::Ppm, -1},
+        {"QOI", ".qoi", Image_Encoder::Qoi, -1},
+    }};
+    for (Encoder_Run const &run : runs)
+    {
+        std::filesystem::path out_path = std::filesystem::temp_directory_path() / (std::string("d_benchmark_encode") + run.extension);
+        double total_ns = 0;
+        bool saved = true;
+        for (size_t rep = 0; rep < BENCHMARK_ENCODE_REPS; rep++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            saved &= d_map.save(out_path.string(), run.encoder, run.setting);
+            auto end = std::chrono::steady_clock::now();
+            total_ns += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        }
+
+        std::error_code error;
+        double file_mb = static_cast<double>(std::filesystem::file_size(out_path, error)) / (1024.0 * 1024.0);
+        double ms = total_ns / BENCHMARK_ENCODE_REPS / 1e6;
+        std::cout << std::format("{:<10} {:>3}x{:<3} ms:{:>10.3f} MB/s:{:>10.1f} file:{:>8.2f}MB ({:>5.1f}% of raw){}",
+                                 run.name,
+                                 size,
+                                 size,
+                                 ms,
+                                 ms > 0 ? canvas_mb / (ms / 1e3) : 0,
+                                 error ? 0 : file_mb,
+                                 error || canvas_mb <= 0 ? 0 : 100.0 * file_mb / canvas_mb,
+                                 saved ? "" : " (failed)")
+                  << std::endl;
+        std::filesystem::remove(out_path, error);
+    }
+
+    // Every level of a Deep Zoom pyramid, composited from the tile levels rather than the canvas.
+    std::filesystem::path dzi_path = std::filesystem::temp_directory_path() / "d_benchmark_pyramid.dzi";
+    std::filesystem::path files_path = std::filesystem::temp_directory_path() / "d_benchmark_pyramid_files";
+    auto start = std::chrono::steady_clock::now();
+    bool saved = d_map.save_pyramid(dzi_path.string());
+    auto end = std::chrono::steady_clock::now();
+    double ms = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / 1e6;
+    std::cout << std::format("{:<10} {:>3}x{:<3} ms:{:>10.3f} MB/s:{:>10.1f}{}",
+                             "DZI JPEG",
+                             size,
+                             size,
+                             ms,
+                             ms > 0 ? canvas_mb / (ms / 1e3) : 0,
+                             saved ? "" : " (failed)")
+              << std::endl;
+    std::error_code error;
+    std::filesystem::remove(dzi_path, error);
+    std::filesystem::remove_all(files_path, error);
+
+    D_Logger::set_level(log_level);
+}
+
+/***********************************************************************************************************************
+ * @brief Times bounded rolls from an engine, bounds cycle through the kinds of rolls generation makes, ie connection
+ * chances, canidate picks and entrance placement.
+ *
+ * @param[in] name Name to print for the engine.
+ * @param[in] state_size Bytes of state a generator using this engine carries.
+ * @param[in] sampler Callable taking the engine and a bound and returning a roll in [0, bound).
+ **********************************************************************************************************************/
+template <typename Engine, typename Sampler>
+void benchmark_rng(std::string const &name, size_t state_size, Sampler sampler)
+{
+    constexpr std::array<uint32_t, 8> bounds = {ONE_HUNDRED_PERCENT + 1, 7, 101, 33, 101, 300, 101, 1024};
+    Engine engine;
+    seed_engine(engine, 0x5EED);
+
+    uint64_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < BENCHMARK_RNG_ROLLS; i++)
+        sink += sampler(engine, bounds[i % bounds.size()]);
+    auto end = std::chrono::steady_clock::now();
+
+    double total_ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    std::cout << std::format("{:<34} state bytes:{:>6} ns/roll:{:>6.2f} (checksum {})",
+                             name,
+                             state_size,
+                             total_ns / BENCHMARK_RNG_ROLLS,
+                             sink)
+              << std::endl;
+}
+
+/***********************************************************************************************************************
+ * @brief Times saving one map as a map layout and loading it back against regenerating it from its seed, printing the
+ * layout's size against a plain grid of 16 bit handles.
+ *
+ * @param[in] size Width and height of the map.
+ **********************************************************************************************************************/
+void benchmark_layouts(uint16_t size)
+{
+    Log_Level log_level = D_Logger::get_level();
+    D_Logger::set_level(Log_Level::Warn);
+
+    std::vector<D_Map_Layout> layouts = D_Map::generate_batch(1, size, size, BENCHMARK_CONNECTION_CHANCE, size,
+                                                              Tile_Map, Generation_Mode::Propagate);
+    D_Map d_map(layouts.front());
+    auto time_reps = [](auto work)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t rep = 0; rep < BENCHMARK_LAYOUT_REPS; rep++)
+            work();
+        auto end = std::chrono::steady_clock::now();
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) /
+               BENCHMARK_LAYOUT_REPS / 1e6;
+    };
+
+    std::vector<char> encoded;
+    double encode_ms = time_reps([&]()
+                                 { encoded = d_map.encode_layout(); });
+    double decode_ms = time_reps([&]()
+                                 { D_Map::decode_layout(reinterpret_cast<unsigned char const *>(encoded.data()),
+                                                        encoded.size(), Tile_Index); });
+    double generate_ms = time_reps([&]()
+                                   { d_map.generate(layouts.front().seed); });
+
+    D_Logger::set_level(log_level);
+
+    size_t raw_bytes = static_cast<size_t>(size) * size * sizeof(uint16_t);
+    std::cout << std::format("{:>4}x{:<4} ms encode:{:>9.3f} decode:{:>9.3f} regenerate:{:>10.3f} "
+                             "bytes:{:>9} ({:.1f}% of raw handles)",
+                             size,
+                             size,
+                             encode_ms,
+                             decode_ms,
+                             generate_ms,
+                             encoded.size(),
+                             100.0 * static_cast<double>(encoded.size()) / static_cast<double>(raw_bytes))
+              << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    std::cout << "- - - - Start D_Builder BENCHMARK - - - -" << std::endl;
+
+    unsigned long max_size = DEFAULT_BENCHMARK_MAX_MAP_SIZE;
+    if (argc == 2)
+    {
+        try
+        {
+            max_size = std::stoul(argv[1]);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << ERR_FORMAT("Invalid max map size given.") << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << "- - - Random Number Engines - - -" << std::endl;
+    benchmark_rng<std::mt19937>("mt19937 + uniform_int_distribution",
+                                sizeof(std::mt19937) + sizeof(std::uniform_int_distribution<unsigned long>),
+                                [](std::mt19937 &engine, uint32_t bound)
+                                {
+                                    // Reparameterised every roll, as generation used to.
+                                    std::uniform_int_distribution<unsigned long> distr(0, bound - 1UL);
+                                    return static_cast<uint32_t>(distr(engine));
+                                });
+    benchmark_rng<std::mt19937>("mt19937 + bounded_roll", sizeof(std::mt19937), [](std::mt19937 &engine, uint32_t bound)
+                                { return bounded_roll(engine, bound); });
+    benchmark_rng<D_Pcg32>("pcg32 + bounded_roll", sizeof(D_Pcg32), [](D_Pcg32 &engine, uint32_t bound)
+                           { return bounded_roll(engine, bound); });
+    benchmark_rng<D_Xoshiro128ss>("xoshiro128** + bounded_roll", sizeof(D_Xoshiro128ss), [](D_Xoshiro128ss &engine, uint32_t bound)
+                                  { return bounded_roll(engine, bound); });
+    std::cout << std::format("D_Map is built with the engine named by D_MAP_RNG_ENGINE ({} state bytes).",
+                             sizeof(D_Map_Rng))
+              << std::endl;
+
+    init_img_dirs();
+    D_Tile::load_tiles(DEFAULT_INPUT_IMG_PATH, "", Image_Load_Mode::Lazy);
+    D_Tile::generate_tiles();
+
+    D_Logger::flush();
+    std::cout << "- - - Map Generation - - -" << std::endl;
+    for (Generation_Mode mode : {Generation_Mode::Greedy, Generation_Mode::Propagate})
+    {
+        std::vector<double> ns_per_cell;
+        for (unsigned long size = BENCHMARK_MIN_MAP_SIZE; size <= max_size; size *= 2)
+        {
+            double size_ns_per_cell = benchmark_generation(static_cast<uint16_t>(size), mode);
+            if (size_ns_per_cell > 0)
+                ns_per_cell.push_back(size_ns_per_cell);
+        }
+
+        if (ns_per_cell.size() > 1)
+            std::cout << std::format("Largest/smallest ns per cell: {:.2f} (1.00 is linear scaling)",
+                                     ns_per_cell.back() / ns_per_cell.front())
+                      << std::endl;
+    }
+
+    std::cout << "- - - Region Regeneration - - -" << std::endl;
+    std::vector<double> us_per_region;
+    for (unsigned long size = BENCHMARK_MIN_MAP_SIZE; size <= max_size; size *= 2)
+    {
+        double size_us_per_region = benchmark_region(static_cast<uint16_t>(size));
+        if (size_us_per_region > 0)
+            us_per_region.push_back(size_us_per_region);
+    }
+
+    if (us_per_region.size() > 1)
+        std::cout << std::format("Largest/smallest map us per region: {:.2f} (1.00 is independent of map size)",
+                                 us_per_region.back() / us_per_region.front())
+                  << std::endl;
+
+    std::cout << "- - - Map Compositing - - -" << std::endl;
+    for (unsigned long size = 2; size <= std::min<unsigned long>(max_size, BENCHMARK_RENDER_MAX_MAP_SIZE); size *= 2)
+        benchmark_render(static_cast<uint16_t>(size));
+
+    std::cout << "- - - Map Previews - - -" << std::endl;
+    benchmark_preview(BENCHMARK_PREVIEW_MAP_SIZE);
+
+    std::cout << "- - - Map Encoding - - -" << std::endl;
+    benchmark_encoders(static_cast<uint16_t>(std::min<unsigned long>(max_size, BENCHMARK_ENCODE_MAP_SIZE)));
+
+    std::cout << "- - - Map Layouts - - -" << std::endl;
+    for (unsigned long size = BENCHMARK_MIN_MAP_SIZE; size <= max_size; size *= 2)
+        benchmark_layouts(static_cast<uint16_t>(size));
+
+    return EXIT_SUCCESS;
+}
@@ -24,6 +24,7 @@
 
 #include "d_map.hpp"
 #include "d_tile.hpp"
+#include "d_tile_index.hpp"
 #include "d_builder_common.hpp"
 
 /*
@@ -36,6 +37,7 @@ std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> Tile_Map = {};
 std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> Entrance_Map = {};
 std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> Exit_Map = {};
 std::shared_ptr<D_Tile> Empty_Tile = nullptr;
+std::shared_ptr<D_Tile_Index const> Tile_Index = nullptr;
 std::unique_ptr<D_Map> Dungeon_Map = nullptr;
 std::string Gen_Flag = GENERATE_IMG_CLI_COMMAND;
 
@@ -53,15 +55,24 @@ int main(int argc, char **argv)
 
     std::cout << "Welcome to D_Builder" << std::endl;
 
+    std::filesystem::path manifest_path(DEFAULT_TILE_MANIFEST_PATH);
+
     if (2 == argc && !Gen_Flag.compare(argv[1]))
     {
-        D_Tile::load_tiles(img_dir, loaded_dir);
-        D_Tile::generate_tiles();
+        // Only rebuild tiles when the input tiles have changed since the last generate.
+        if (D_Tile::sync_loaded_tiles(img_dir, loaded_dir, DEFAULT_TILE_CACHE_PATH) ||
+            !D_Tile::load_manifest(manifest_path, Image_Load_Mode::Lazy))
+        {
+            D_Tile::load_tiles(loaded_dir, "", Image_Load_Mode::Lazy);
+            D_Tile::generate_tiles(manifest_path);
+        }
     }
-    else // Only loading required.
+    else if (!D_Tile::load_manifest(manifest_path, Image_Load_Mode::Lazy)) // Only loading required.
     {
-        LOG_DEBUG("Skipping tile generation...");
-        D_Tile::load_tiles(loaded_dir);
+        LOG_INFO("Falling back on scanning the loaded directory...");
+        D_Tile::load_tiles(loaded_dir, "", Image_Load_Mode::Lazy);
+        //! NOTE: Permutations are not saved to the loaded directory, they are cheap to rebuild.
+        D_Tile::generate_tiles(manifest_path);
     }
 
     Dungeon_Map = std::make_unique<D_Map>(3, 3, 50, Tile_Map);
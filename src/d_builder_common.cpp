@@ -13,6 +13,12 @@
 
 #include <filesystem>
 #include <sstream>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <exception>
+#include <algorithm>
 
 /*
 ========================================================================================================================
@@ -60,3 +66,70 @@ void init_img_dirs(void)
     std::filesystem::create_directories(loaded_path);
     std::filesystem::create_directories(output_path);
 }
+
+/***********************************************************************************************************************
+ * @brief Gets the number of threads to use for parallel work.
+ *
+ * @retval unsigned int The available hardware thread count, or DEFAULT_THREAD_COUNT if it cannot be detected.
+ **********************************************************************************************************************/
+unsigned int available_threads(void)
+{
+    unsigned int thread_count = std::thread::hardware_concurrency();
+    return thread_count ? thread_count : DEFAULT_THREAD_COUNT;
+}
+
+/***********************************************************************************************************************
+ * @brief Runs a job for every index in [0, job_count) across a pool of worker threads, the calling thread also works.
+ * Jobs are handed out one index at a time so uneven jobs balance across the workers.
+ *
+ * @param[in] job_count Number of jobs to run.
+ * @param[in] job Job to run, called with the index of the job. Jobs must only write to state owned by their index.
+ *
+ * @throws Rethrows the first exception thrown by a job once all workers have stopped, remaining jobs are skipped.
+ **********************************************************************************************************************/
+void run_parallel(size_t job_count, std::function<void(size_t)> const &job)
+{
+    if (!job_count)
+        return;
+
+    size_t thread_count = std::min(static_cast<size_t>(available_threads()), job_count);
+    std::atomic<size_t> next_job{0};
+    std::exception_ptr job_exception = nullptr;
+    std::mutex exception_mtx;
+
+    auto worker = [&]()
+    {
+        for (size_t idx = next_job.fetch_add(1); idx < job_count; idx = next_job.fetch_add(1))
+        {
+            try
+            {
+                job(idx);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(exception_mtx);
+                if (!job_exception)
+                    job_exception = std::current_exception();
+                next_job.store(job_count);
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count - 1);
+    for (size_t i = 1; i < thread_count; i++)
+    {
+        workers.emplace_back(worker);
+    }
+    worker();
+
+    for (auto &thread : workers)
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+
+    if (job_exception)
+        std::rethrow_exception(job_exception);
+}
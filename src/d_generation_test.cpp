@@ -16,8 +16,15 @@
 #include <filesystem>
 #include <string>
 #include <format>
-#include <mutex>
-#include <thread>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <bit>
+#include <chrono>
 
 /*
 ========================================================================================================================
@@ -27,6 +34,8 @@
 
 #include "d_map.hpp"
 #include "d_tile.hpp"
+#include "d_tile_index.hpp"
+#include "d_thread_pool.hpp"
 #include "d_builder_common.hpp"
 
 /*
@@ -39,67 +48,804 @@ std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> Tile_Map = {};
 std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> Entrance_Map = {};
 std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> Exit_Map = {};
 std::shared_ptr<D_Tile> Empty_Tile = nullptr;
+std::shared_ptr<D_Tile_Index const> Tile_Index = nullptr;
 std::unique_ptr<D_Map> Dungeon_Map = nullptr;
 std::string Gen_Flag = GENERATE_IMG_CLI_COMMAND;
-std::atomic<uint64_t> G = 0;
+uint64_t G = 0;
 uint64_t G_MAX = UINT64_MAX;
+std::vector<std::atomic<uint64_t>> Used_Tile_Words = {};
 
-struct Lockable_Map
+/*
+========================================================================================================================
+- - Macros - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Number of maps generated per available thread in each test batch.
+ **********************************************************************************************************************/
+#define TEST_BATCH_MAPS_PER_THREAD (4)
+
+/***********************************************************************************************************************
+ * @brief Number of designs generated in each mode when comparing dead ends.
+ **********************************************************************************************************************/
+#define TEST_SOLVER_MAPS (200)
+
+/***********************************************************************************************************************
+ * @brief Width and height of the maps generated when comparing dead ends.
+ **********************************************************************************************************************/
+#define TEST_SOLVER_MAP_SIZE (12)
+
+/***********************************************************************************************************************
+ * @brief Connection chance of the maps generated when comparing dead ends, high enough that Greedy often hits one.
+ **********************************************************************************************************************/
+#define TEST_SOLVER_CONNECTION_CHANCE (95)
+
+/***********************************************************************************************************************
+ * @brief Number of random regions regenerated on one map.
+ **********************************************************************************************************************/
+#define TEST_REGION_EDITS (200)
+
+/***********************************************************************************************************************
+ * @brief Width and height of the map regions are regenerated on.
+ **********************************************************************************************************************/
+#define TEST_REGION_MAP_SIZE (24)
+
+/***********************************************************************************************************************
+ * @brief Columns of the map rendered in strips, enough that each strip is drawn in parallel bands of columns.
+ **********************************************************************************************************************/
+#define TEST_STREAM_MAP_COLS (MAP_RENDER_PARALLEL_MIN_CELLS)
+
+/***********************************************************************************************************************
+ * @brief Rows of the map rendered in strips.
+ **********************************************************************************************************************/
+#define TEST_STREAM_MAP_ROWS (3)
+
+/***********************************************************************************************************************
+ * @brief Number of designs generated in each mode and saved as map layouts.
+ **********************************************************************************************************************/
+#define TEST_LAYOUT_MAPS (8)
+
+/***********************************************************************************************************************
+ * @brief Number of times every cell of a batch is resolved to its tile when timing tile handles against shared tiles.
+ **********************************************************************************************************************/
+#define TEST_TILE_LOOKUP_REPS (64)
+
+/*
+========================================================================================================================
+- - Main Start - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Counts the tile index slots that have been placed in a generated map.
+ *
+ * @retval size_t Number of bits set in Used_Tile_Words.
+ **********************************************************************************************************************/
+size_t count_used_tiles()
+{
+    size_t used = 0;
+    for (std::atomic<uint64_t> const &word : Used_Tile_Words)
+        used += static_cast<size_t>(std::popcount(word.load(std::memory_order_relaxed)));
+    return used;
+}
+
+/***********************************************************************************************************************
+ * @brief Generates batches of maps until every tile has been used or the generation limit is hit, outputting the
+ * designs to a folder.
+ *
+ * @param[in] seed Seed of the first batch.
+ **********************************************************************************************************************/
+void test_generations(uint64_t seed)
+{
+    size_t batch_size = static_cast<size_t>(D_Thread_Pool::shared().size()) * TEST_BATCH_MAPS_PER_THREAD;
+    size_t const empty_tile_slot = Tile_Index->find_slot(Empty_Tile->get_id());
+    while (count_used_tiles() < Tile_Index->size() && G < G_MAX)
+    {
+        size_t count = static_cast<size_t>(std::min<uint64_t>(batch_size, G_MAX - G));
+        std::vector<D_Map_Layout> layouts = D_Map::generate_batch(count, 5, 5, 80, seed + G, Tile_Map,
+                                                                  Generation_Mode::Greedy);
+
+        // Saving is independent per map, so it runs on the same pool.
+        uint64_t first_g = G;
+        D_Thread_Pool::shared().run(layouts.size(), [&](size_t job_idx, [[maybe_unused]] size_t worker_idx)
+                                    {
+                                        std::string file_name = std::format("{}Size-10x10_G{}.jpg", DEFAULT_TEST_OUTPUT_IMG_PATH, first_g + job_idx);
+                                        if (!D_Map(layouts[job_idx]).save(file_name))
+                                            throw std::runtime_error(ERR_FORMAT("Failed saving map!"));
+                                        for (uint16_t handle : layouts[job_idx].tiles)
+                                        {
+                                            size_t slot = (MAP_EMPTY_TILE_HANDLE == handle) ? empty_tile_slot : handle;
+                                            Used_Tile_Words[slot / TILE_INDEX_WORD_BITS].fetch_or(
+                                                1ULL << (slot % TILE_INDEX_WORD_BITS), std::memory_order_relaxed);
+                                        }
+                                        LOG_DEBUG(std::format("Map generated, filename = {}", file_name)); });
+        G += layouts.size();
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Resolves every cell of a batch of designs to its tile across the shared pool, once as tile handles into the
+ * tile index arena and once as copied std::shared_ptrs, ie how maps used to hold their tiles. Every copy of a shared
+ * tile touches its reference count, so threads placing the same tiles (ie the Empty_Tile) contend on it.
+ *
+ * @param[in] seed Seed of the batch.
+ *
+ * @throws std::runtime_error If the two ways resolve to different tiles.
+ **********************************************************************************************************************/
+void test_tile_handle_throughput(uint64_t seed)
+{
+    D_Thread_Pool &pool = D_Thread_Pool::shared();
+    std::vector<D_Map_Layout> layouts = D_Map::generate_batch(pool.size() * TEST_BATCH_MAPS_PER_THREAD,
+                                                              TEST_REGION_MAP_SIZE, TEST_REGION_MAP_SIZE,
+                                                              TEST_SOLVER_CONNECTION_CHANCE, seed, Tile_Map,
+                                                              Generation_Mode::Propagate);
+    std::vector<std::shared_ptr<D_Tile>> shared_slots;
+    shared_slots.reserve(Tile_Index->size());
+    for (size_t slot = 0; slot < Tile_Index->size(); slot++)
+        shared_slots.push_back(Tile_Map.at(Tile_Index->get_tile(slot)->get_id()));
+
+    // Each job places its design's tiles TEST_TILE_LOOKUP_REPS times, summing ids so neither loop can be skipped.
+    std::vector<uint64_t> handle_sums(layouts.size(), 0);
+    std::vector<uint64_t> shared_sums(layouts.size(), 0);
+    auto time_jobs = [&](auto place_tiles)
+    {
+        auto start = std::chrono::steady_clock::now();
+        pool.run(layouts.size(), [&](size_t job_idx, [[maybe_unused]] size_t worker_idx)
+                 { place_tiles(job_idx); });
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(end - start).count();
+    };
+    double handle_seconds = time_jobs([&](size_t job_idx)
+                                      {
+                                          std::vector<D_Tile *> placed(layouts[job_idx].tiles.size());
+                                          for (size_t rep = 0; rep < TEST_TILE_LOOKUP_REPS; rep++)
+                                          {
+                                              for (size_t cell = 0; cell < placed.size(); cell++)
+                                              {
+                                                  uint16_t handle = layouts[job_idx].tiles[cell];
+                                                  if (MAP_EMPTY_TILE_HANDLE == handle)
+                                                      placed[cell] = Empty_Tile.get();
+                                                  else
+                                                      placed[cell] = Tile_Index->get_tile(handle);
+                                              }
+                                              for (D_Tile const *tile : placed)
+                                                  handle_sums[job_idx] += tile->get_id();
+                                          } });
+    double shared_seconds = time_jobs([&](size_t job_idx)
+                                      {
+                                          std::vector<std::shared_ptr<D_Tile>> placed(layouts[job_idx].tiles.size());
+                                          for (size_t rep = 0; rep < TEST_TILE_LOOKUP_REPS; rep++)
+                                          {
+                                              for (size_t cell = 0; cell < placed.size(); cell++)
+                                              {
+                                                  uint16_t handle = layouts[job_idx].tiles[cell];
+                                                  if (MAP_EMPTY_TILE_HANDLE == handle)
+                                                      placed[cell] = Empty_Tile;
+                                                  else
+                                                      placed[cell] = shared_slots[handle];
+                                              }
+                                              for (std::shared_ptr<D_Tile> const &tile : placed)
+                                                  shared_sums[job_idx] += tile->get_id();
+                                          } });
+
+    if (handle_sums != shared_sums)
+        throw std::runtime_error(ERR_FORMAT("Tile handles resolved to different tiles than the shared tiles!"));
+
+    double cells = static_cast<double>(layouts.size() * layouts.front().tiles.size() * TEST_TILE_LOOKUP_REPS);
+    LOG_INFO(std::format("Placed tiles across {} threads, handles: {:.1f}M cells/s, shared tiles: {:.1f}M cells/s "
+                         "({:.1f}x).",
+                         pool.size(),
+                         cells / handle_seconds / 1e6,
+                         cells / shared_seconds / 1e6,
+                         shared_seconds / handle_seconds));
+}
+
+/***********************************************************************************************************************
+ * @brief Checks that the same settings and seed always produce the same design, for single maps and for batches.
+ *
+ * @param[in] seed Seed to start searching from, seeds that hit a dead end are skipped.
+ *
+ * @throws std::runtime_error if a design could not be reproduced from its seed.
+ **********************************************************************************************************************/
+void test_seeded_generation(uint64_t seed)
 {
-    std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> data;
-    mutable std::mutex mtx;
+    std::unique_ptr<D_Map> first = nullptr;
+    for (; !first; seed++)
+    {
+        try
+        {
+            first = std::make_unique<D_Map>(8, 8, 60, Tile_Map, seed);
+        }
+        catch (std::runtime_error const &)
+        {
+            continue;
+        }
+    }
+
+    D_Map second(8, 8, 60, Tile_Map, first->get_seed());
+    if (second.get_tile_grid() != first->get_tile_grid())
+        throw std::runtime_error(ERR_FORMAT(std::format("Seed {} did not reproduce its design!", first->get_seed())));
 
-    size_t size() const
+    // Regenerating an existing map from a seed must give the same design as constructing from it.
+    second.generate();
+    second.generate(first->get_seed());
+    if (second.get_tile_grid() != first->get_tile_grid())
+        throw std::runtime_error(ERR_FORMAT(std::format("Regenerating seed {} did not reproduce its design!", first->get_seed())));
+
+    std::vector<D_Map_Layout> batch_a = D_Map::generate_batch(16, 6, 6, 70, seed, Tile_Map, Generation_Mode::Greedy);
+    std::vector<D_Map_Layout> batch_b = D_Map::generate_batch(16, 6, 6, 70, seed, Tile_Map, Generation_Mode::Greedy);
+    for (size_t i = 0; i < batch_a.size(); i++)
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        return data.size();
+        if (batch_a[i].seed != batch_b[i].seed || batch_a[i].tiles != batch_b[i].tiles)
+            throw std::runtime_error(ERR_FORMAT(std::format("Batch seed {} did not reproduce map {}!", seed, i)));
     }
 
-    void reserve(size_t s)
+    LOG_INFO(std::format("Seeded generation reproduced designs from seed {}.", first->get_seed()));
+}
+
+/***********************************************************************************************************************
+ * @brief Checks that every side of every tile in a design meets its neighboor's mirrored side, and that no tile
+ * connects off the map.
+ *
+ * @param[in] d_map Map to check.
+ *
+ * @retval bool True if every connection in the design is matched.
+ **********************************************************************************************************************/
+bool connections_match(D_Map const &d_map)
+{
+    for (uint16_t row = 0; row < d_map.get_rows(); row++)
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        data.reserve(s);
+        for (uint16_t col = 0; col < d_map.get_cols(); col++)
+        {
+            D_Connections connections = d_map.get_tile(col, row)->get_connections();
+            for (size_t side = 0; side < MAX_NEIGHBOORS; side++)
+            {
+                uint16_t n_col = col + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[side].first);
+                uint16_t n_row = row + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[side].second);
+                uint8_t facing = CONNECTION_ZERO_MASK;
+                if (n_col < d_map.get_cols() && n_row < d_map.get_rows())
+                    facing = reverse_8bits(d_map.get_tile(n_col, n_row)->get_connections().sides[TILE_NEIGHBOOR_SIDE_IDX_MIRRORS[side]]);
+                if (connections.sides[side] != facing)
+                    return false;
+            }
+        }
     }
+    return true;
+}
 
-    bool emplace(uint64_t id, std::shared_ptr<D_Tile> tile)
+/***********************************************************************************************************************
+ * @brief Checks the tile index's per side compatibility tables against a neighboor support query for each slot alone.
+ *
+ * @param[in] tile_index Index to check.
+ *
+ * @throws std::runtime_error if a slot's table disagrees with its support query.
+ **********************************************************************************************************************/
+void test_compatibility_tables(D_Tile_Index const &tile_index)
+{
+    size_t word_count = tile_index.get_domain_word_count();
+    std::vector<uint64_t> single_words(word_count, 0);
+    std::vector<uint64_t> support_words(word_count, 0);
+    for (size_t slot = 0; slot <= tile_index.get_empty_slot(); slot++)
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        return data.emplace(id, tile).second;
+        std::fill(single_words.begin(), single_words.end(), 0);
+        single_words[slot / TILE_INDEX_WORD_BITS] = 1ULL << (slot % TILE_INDEX_WORD_BITS);
+        for (size_t side = 0; side < MAX_NEIGHBOORS; side++)
+        {
+            tile_index.side_support(TILE_NEIGHBOOR_SIDE_IDX_MIRRORS[side], single_words.data(), support_words.data());
+            if (!std::equal(support_words.begin(), support_words.end(), tile_index.compatible_domain(slot, side)))
+                throw std::runtime_error(ERR_FORMAT(std::format("Compatibility table of slot {} side {} is wrong!", slot, side)));
+        }
     }
-};
 
-Lockable_Map Used_Tiles;
+    LOG_INFO(std::format("Compatibility tables checked for {} slots.", tile_index.get_empty_slot() + 1));
+}
 
-/*
-========================================================================================================================
-- - Main Start - -
-========================================================================================================================
-*/
+/***********************************************************************************************************************
+ * @brief Generates the same seeds in the Greedy and Propagate modes at a high connection chance and compares dead ends.
+ * Propagate designs must never hit a dead end, must match every connection and must reproduce from their seeds.
+ *
+ * @param[in] seed Seed of the first design.
+ *
+ * @throws std::runtime_error if a Propagate design fails any of the above.
+ **********************************************************************************************************************/
+void test_propagate_generation(uint64_t seed)
+{
+    std::vector<D_Map_Layout> first = D_Map::generate_batch(1, TEST_SOLVER_MAP_SIZE, TEST_SOLVER_MAP_SIZE,
+                                                            TEST_SOLVER_CONNECTION_CHANCE, seed, Tile_Map,
+                                                            Generation_Mode::Propagate);
+    D_Map d_map(first.front());
+    test_compatibility_tables(*first.front().tile_index);
+
+    size_t greedy_dead_ends = 0;
+    size_t propagate_dead_ends = 0;
+    for (uint64_t i = 0; i < TEST_SOLVER_MAPS; i++)
+    {
+        d_map.set_generation_mode(Generation_Mode::Greedy);
+        try
+        {
+            d_map.generate(seed + i);
+        }
+        catch (std::runtime_error const &)
+        {
+            greedy_dead_ends++;
+        }
+
+        d_map.set_generation_mode(Generation_Mode::Propagate);
+        try
+        {
+            d_map.generate(seed + i);
+        }
+        catch (std::runtime_error const &)
+        {
+            propagate_dead_ends++;
+            continue;
+        }
+
+        if (!connections_match(d_map))
+            throw std::runtime_error(ERR_FORMAT(std::format("Propagate seed {} has unmatched connections!", seed + i)));
+    }
+
+    LOG_INFO(std::format("{}x{} at {}% connection chance, dead ends over {} seeds: Greedy {}, Propagate {}.",
+                         TEST_SOLVER_MAP_SIZE,
+                         TEST_SOLVER_MAP_SIZE,
+                         TEST_SOLVER_CONNECTION_CHANCE,
+                         TEST_SOLVER_MAPS,
+                         greedy_dead_ends,
+                         propagate_dead_ends));
+    if (propagate_dead_ends)
+        throw std::runtime_error(ERR_FORMAT(std::format("Propagate mode hit {} dead ends!", propagate_dead_ends)));
+
+    std::vector<D_Map_Layout> batch_a = D_Map::generate_batch(16, 10, 10, 90, seed, Tile_Map, Generation_Mode::Propagate);
+    std::vector<D_Map_Layout> batch_b = D_Map::generate_batch(16, 10, 10, 90, seed, Tile_Map, Generation_Mode::Propagate);
+    for (size_t i = 0; i < batch_a.size(); i++)
+    {
+        if (batch_a[i].seed != batch_b[i].seed || batch_a[i].tiles != batch_b[i].tiles)
+            throw std::runtime_error(ERR_FORMAT(std::format("Propagate batch seed {} did not reproduce map {}!", seed, i)));
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Regenerates random regions of a Propagate design, every tile outside a region must be kept and every
+ * connection must still match afterwards.
+ *
+ * @param[in] seed Seed of the design and the regions.
+ *
+ * @throws std::runtime_error if a region fails, changes a tile outside of it or leaves an unmatched connection.
+ **********************************************************************************************************************/
+void test_region_generation(uint64_t seed)
+{
+    // Some entrances wall themselves in, edit a design that fills at least half the map.
+    std::vector<D_Map_Layout> first;
+    do
+    {
+        first = D_Map::generate_batch(1, TEST_REGION_MAP_SIZE, TEST_REGION_MAP_SIZE, TEST_SOLVER_CONNECTION_CHANCE,
+                                      seed++, Tile_Map, Generation_Mode::Propagate);
+    } while (std::count(first.front().tiles.begin(), first.front().tiles.end(), MAP_EMPTY_TILE_HANDLE) >
+             TEST_REGION_MAP_SIZE * TEST_REGION_MAP_SIZE / 2);
+    D_Map d_map(first.front());
+    std::mt19937_64 region_gen(seed);
+    std::uniform_int_distribution<uint16_t> point_distr(0, TEST_REGION_MAP_SIZE - 1);
+    size_t changed_regions = 0;
+    for (size_t edit = 0; edit < TEST_REGION_EDITS; edit++)
+    {
+        uint16_t col0 = point_distr(region_gen);
+        uint16_t col1 = point_distr(region_gen);
+        uint16_t row0 = point_distr(region_gen);
+        uint16_t row1 = point_distr(region_gen);
+        if (col0 > col1)
+            std::swap(col0, col1);
+        if (row0 > row1)
+            std::swap(row0, row1);
+        std::vector<uint16_t> before = d_map.get_tile_grid();
+        d_map.regenerate_region(col0, row0, col1, row1);
+
+        std::vector<uint16_t> const &after = d_map.get_tile_grid();
+        for (uint16_t row = 0; row < TEST_REGION_MAP_SIZE; row++)
+        {
+            for (uint16_t col = 0; col < TEST_REGION_MAP_SIZE; col++)
+            {
+                size_t cell = static_cast<size_t>(row) * TEST_REGION_MAP_SIZE + col;
+                bool inside = col >= col0 && col <= col1 && row >= row0 && row <= row1;
+                if (!inside && before[cell] != after[cell])
+                    throw std::runtime_error(ERR_FORMAT(std::format("Region ({}, {})-({}, {}) changed tile ({}, {})!",
+                                                                    col0, row0, col1, row1, col, row)));
+            }
+        }
+        if (!connections_match(d_map))
+            throw std::runtime_error(ERR_FORMAT(std::format("Region ({}, {})-({}, {}) left unmatched connections!",
+                                                            col0, row0, col1, row1)));
+        changed_regions += before != after;
+    }
+
+    bool rejected = false;
+    try
+    {
+        d_map.regenerate_region(1, 0, 0, 0);
+    }
+    catch (std::out_of_range const &)
+    {
+        rejected = true;
+    }
+    if (!rejected)
+        throw std::runtime_error(ERR_FORMAT("An inverted region was not rejected!"));
+
+    LOG_INFO(std::format("Regenerated {} regions of a {}x{} map, {} changed its design.",
+                         TEST_REGION_EDITS,
+                         TEST_REGION_MAP_SIZE,
+                         TEST_REGION_MAP_SIZE,
+                         changed_regions));
+}
+
+/***********************************************************************************************************************
+ * @brief Edits a rendered design with swaps, a region and a new generation, re-rendering after each, and compares the
+ * incrementally updated canvas with a fresh render of the same design.
+ *
+ * @param[in] seed Seed of the design.
+ *
+ * @throws std::runtime_error if an incremental render differs from a fresh one.
+ **********************************************************************************************************************/
+void test_incremental_render(uint64_t seed)
+{
+    std::vector<D_Map_Layout> first = D_Map::generate_batch(1, 8, 8, TEST_SOLVER_CONNECTION_CHANCE, seed, Tile_Map,
+                                                            Generation_Mode::Propagate);
+    D_Map d_map(first.front());
+    d_map.render();
+
+    auto check_render = [&](std::string const &edit)
+    {
+        if (d_map.render() != D_Map(d_map.get_layout()).render())
+            throw std::runtime_error(ERR_FORMAT(std::format("Render after {} differs from a fresh render!", edit)));
+    };
+
+    d_map.swap_tile(0, 0, Empty_Tile);
+    d_map.swap_tile(7, 7, Tile_Map.begin()->second);
+    check_render("swapping tiles");
+    d_map.regenerate_region(2, 2, 5, 5);
+    check_render("regenerating a region");
+    d_map.generate(seed + 1);
+    check_render("generating");
+
+    LOG_INFO("Incremental renders matched fresh renders.");
+}
+
+/***********************************************************************************************************************
+ * @brief Checks that strips from render_strips() cover the rendered canvas exactly and that a streamed save writes the
+ * same file as saving the rendered canvas.
+ *
+ * @param[in] seed Seed of the design.
+ *
+ * @throws std::runtime_error If a strip or the streamed file differs.
+ **********************************************************************************************************************/
+void test_streamed_render(uint64_t seed)
+{
+    std::vector<D_Map_Layout> layouts = D_Map::generate_batch(1, TEST_STREAM_MAP_COLS, TEST_STREAM_MAP_ROWS,
+                                                              TEST_SOLVER_CONNECTION_CHANCE, seed, Tile_Map,
+                                                              Generation_Mode::Propagate);
+    D_Map d_map(layouts.front());
+    QImage const &canvas = d_map.render();
+
+    int next_y = 0;
+    d_map.render_strips([&](QImage const &strip, int strip_y)
+                        {
+                            if (strip_y != next_y || strip != canvas.copy(0, strip_y, canvas.width(), strip.height()))
+                                throw std::runtime_error(ERR_FORMAT(std::format("Strip at y {} differs from the canvas!", strip_y)));
+                            next_y += strip.height(); });
+    if (next_y != canvas.height())
+        throw std::runtime_error(ERR_FORMAT("Strips did not cover the canvas!"));
+
+    std::filesystem::create_directories(DEFAULT_TEST_OUTPUT_IMG_PATH);
+    std::string saved_name = std::format("{}Streamed_Reference.ppm", DEFAULT_TEST_OUTPUT_IMG_PATH);
+    std::string streamed_name = std::format("{}Streamed.ppm", DEFAULT_TEST_OUTPUT_IMG_PATH);
+    if (!d_map.save(saved_name) || !d_map.save_streamed(streamed_name))
+        throw std::runtime_error(ERR_FORMAT("Failed to save the streamed render test maps!"));
+
+    auto read_file = [](std::string const &file_name)
+    {
+        std::ifstream file(file_name, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    };
+    if (read_file(saved_name) != read_file(streamed_name))
+        throw std::runtime_error(ERR_FORMAT("Streamed save differs from the rendered save!"));
+
+    LOG_INFO("Streamed renders matched the canvas.");
+}
+
+/***********************************************************************************************************************
+ * @brief Decodes a 4 channel QOI file, written independently of D_Map's encoder so a shared mistake cannot hide.
+ *
+ * @param[in] data Whole QOI file.
+ *
+ * @retval QImage The decoded image in TILE_IMAGE_FORMAT, null if the header is not a 4 channel QOI header.
+ **********************************************************************************************************************/
+QImage decode_qoi(std::string const &data)
+{
+    if (data.size() < 22 || data.compare(0, 4, "qoif") || 4 != data[12])
+        return QImage();
+
+    auto byte = [&data](size_t pos)
+    { return static_cast<uint8_t>(data[pos]); };
+    auto read_u32 = [&](size_t pos)
+    { return static_cast<uint32_t>(byte(pos) << 24 | byte(pos + 1) << 16 | byte(pos + 2) << 8 | byte(pos + 3)); };
+    int width = static_cast<int>(read_u32(4));
+    int height = static_cast<int>(read_u32(8));
+
+    QImage image(width, height, TILE_IMAGE_FORMAT);
+    std::array<std::array<uint8_t, 4>, 64> seen = {};
+    std::array<uint8_t, 4> pixel = {0, 0, 0, 255}; // r, g, b, a
+    size_t pos = 14;
+    int run = 0;
+    for (int y = 0; y < height; y++)
+    {
+        QRgb *line = reinterpret_cast<QRgb *>(image.bits() + y * image.bytesPerLine());
+        for (int x = 0; x < width; x++)
+        {
+            if (run)
+            {
+                run--;
+            }
+            else if (pos < data.size() - 8)
+            {
+                uint8_t op = byte(pos++);
+                if (0xFE == op)
+                {
+                    pixel = {byte(pos), byte(pos + 1), byte(pos + 2), pixel[3]};
+                    pos += 3;
+                }
+                else if (0xFF == op)
+                {
+                    pixel = {byte(pos), byte(pos + 1), byte(pos + 2), byte(pos + 3)};
+                    pos += 4;
+                }
+                else if (0x00 == (op & 0xC0))
+                {
+                    pixel = seen[op];
+                }
+                else if (0x40 == (op & 0xC0))
+                {
+                    pixel[0] = static_cast<uint8_t>(pixel[0] + ((op >> 4) & 0x03) - 2);
+                    pixel[1] = static_cast<uint8_t>(pixel[1] + ((op >> 2) & 0x03) - 2);
+                    pixel[2] = static_cast<uint8_t>(pixel[2] + (op & 0x03) - 2);
+                }
+                else if (0x80 == (op & 0xC0))
+                {
+                    int green = (op & 0x3F) - 32;
+                    uint8_t next = byte(pos++);
+                    pixel[0] = static_cast<uint8_t>(pixel[0] + green + (next >> 4) - 8);
+                    pixel[1] = static_cast<uint8_t>(pixel[1] + green);
+                    pixel[2] = static_cast<uint8_t>(pixel[2] + green + (next & 0x0F) - 8);
+                }
+                else
+                {
+                    run = op & 0x3F;
+                }
+                seen[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64] = pixel;
+            }
+            line[x] = qRgba(pixel[0], pixel[1], pixel[2], pixel[3]);
+        }
+    }
+    return image;
+}
+
+/***********************************************************************************************************************
+ * @brief Checks that a map saved as QOI decodes back to the rendered canvas and that out of range encoder settings
+ * are refused.
+ *
+ * @param[in] seed Seed of the design.
+ *
+ * @throws std::runtime_error If the decoded image differs or a bad setting is accepted.
+ **********************************************************************************************************************/
+void test_lossless_encoders(uint64_t seed)
+{
+    std::vector<D_Map_Layout> layouts = D_Map::generate_batch(1, 12, 10, TEST_SOLVER_CONNECTION_CHANCE, seed, Tile_Map,
+                                                              Generation_Mode::Propagate);
+    D_Map d_map(layouts.front());
+
+    std::filesystem::create_directories(DEFAULT_TEST_OUTPUT_IMG_PATH);
+    std::string file_name = std::format("{}Lossless.qoi", DEFAULT_TEST_OUTPUT_IMG_PATH);
+    if (!d_map.save(file_name))
+        throw std::runtime_error(ERR_FORMAT("Failed to save the QOI test map!"));
+
+    std::ifstream file(file_name, std::ios::binary);
+    QImage decoded = decode_qoi(std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+    if (decoded != d_map.render())
+        throw std::runtime_error(ERR_FORMAT("Decoded QOI map differs from the render!"));
+
+    for (auto [encoder, setting] : {std::pair{Image_Encoder::Png, 10}, std::pair{Image_Encoder::Jpeg, 101}})
+    {
+        try
+        {
+            d_map.save(std::format("{}Refused.img", DEFAULT_TEST_OUTPUT_IMG_PATH), encoder, setting);
+            throw std::runtime_error(ERR_FORMAT(std::format("Encoder setting {} was accepted!", setting)));
+        }
+        catch (std::invalid_argument const &)
+        {
+        }
+    }
+
+    LOG_INFO("QOI map decoded to its render.");
+}
 
 /***********************************************************************************************************************
- * @brief Iterates through maps of varying sizes and outputs the designs to a folder.
+ * @brief Checks that a saved Deep Zoom pyramid has every level and tile a viewer expects, that its full size level
+ * matches the rendered canvas and that tile image levels halve down to 1x1.
+ *
+ * @param[in] seed Seed of the design.
+ *
+ * @throws std::runtime_error If a level, tile or pixel is wrong.
  **********************************************************************************************************************/
-void test_generations(size_t t_number)
+void test_pyramid(uint64_t seed)
 {
-    LOG_DEBUG(std::format("Starting thread[{}]", t_number));
-    D_Map d_map(5, 5, 80, Tile_Map);
-    while (Used_Tiles.size() < Tile_Map.size() && G < G_MAX)
+    std::vector<D_Map_Layout> layouts = D_Map::generate_batch(1, 5, 3, TEST_SOLVER_CONNECTION_CHANCE, seed, Tile_Map,
+                                                              Generation_Mode::Propagate);
+    D_Map d_map(layouts.front());
+    QImage const &canvas = d_map.render();
+
+    D_Tile *tile = d_map.get_tile(0, 0);
+    for (size_t level = 1; level < tile->get_level_count(); level++)
     {
-        d_map.generate();
-        uint64_t current_g = G.fetch_add(1);
-        std::string file_name = std::format("{}Size-10x10_G{}.jpg", DEFAULT_TEST_OUTPUT_IMG_PATH, current_g);
-        if (!d_map.save(file_name))
-            throw std::runtime_error(ERR_FORMAT("Failed saving map!"));
-        LOG_DEBUG(std::format("Map generated, filename = {}", file_name));
-        for (auto &&col : d_map.get_display_mat())
+        QImage const &larger = tile->get_image_level(level - 1);
+        QImage const &smaller = tile->get_image_level(level);
+        if (smaller.width() != (larger.width() + 1) / 2 || smaller.height() != (larger.height() + 1) / 2)
+            throw std::runtime_error(ERR_FORMAT(std::format("Tile level {} is not half of the level before!", level)));
+    }
+    QImage const &last = tile->get_image_level(tile->get_level_count() - 1);
+    if (1 != last.width() || 1 != last.height())
+        throw std::runtime_error(ERR_FORMAT("Last tile level is not 1x1!"));
+
+    std::filesystem::path dzi_path = std::filesystem::path(DEFAULT_TEST_OUTPUT_IMG_PATH) / "Pyramid.dzi";
+    std::filesystem::path files_path = std::filesystem::path(DEFAULT_TEST_OUTPUT_IMG_PATH) / "Pyramid_files";
+    std::filesystem::remove_all(files_path);
+    std::filesystem::create_directories(DEFAULT_TEST_OUTPUT_IMG_PATH);
+    if (!d_map.save_pyramid(dzi_path.string(), Image_Encoder::Png) || !std::filesystem::exists(dzi_path))
+        throw std::runtime_error(ERR_FORMAT("Failed to save the test pyramid!"));
+
+    int width = canvas.width();
+    int height = canvas.height();
+    size_t level = static_cast<size_t>(std::bit_width(static_cast<unsigned>(std::max(width, height) - 1)));
+    for (bool full_size = true;; full_size = false, level--)
+    {
+        for (int y = 0; y < height; y += MAP_PYRAMID_TILE_SIZE)
         {
-            for (auto &&tile : col)
+            for (int x = 0; x < width; x += MAP_PYRAMID_TILE_SIZE)
             {
-                Used_Tiles.emplace(tile->get_id(), tile);
+                std::filesystem::path tile_path = files_path / std::to_string(level) /
+                                                  std::format("{}_{}.png", x / MAP_PYRAMID_TILE_SIZE, y / MAP_PYRAMID_TILE_SIZE);
+                QImage saved(QString::fromStdString(tile_path.string()));
+                QImage expected = canvas.copy(x, y, std::min(MAP_PYRAMID_TILE_SIZE, width - x), std::min(MAP_PYRAMID_TILE_SIZE, height - y));
+                if (saved.isNull() || saved.width() != expected.width() || saved.height() != expected.height() ||
+                    (full_size && saved.convertToFormat(TILE_IMAGE_FORMAT) != expected))
+                    throw std::runtime_error(ERR_FORMAT(std::format("Pyramid tile {} is wrong!", tile_path.string())));
             }
         }
+        if (!level)
+            break;
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+    }
+
+    LOG_INFO("Pyramid levels matched the canvas.");
+}
+
+/***********************************************************************************************************************
+ * @brief Checks that a map preview places each cell's preview level tile image where its cell lies.
+ *
+ * @param[in] seed Seed of the design.
+ *
+ * @throws std::runtime_error If the preview's size or a cell differs.
+ **********************************************************************************************************************/
+void test_preview(uint64_t seed)
+{
+    std::vector<D_Map_Layout> layouts = D_Map::generate_batch(1, 6, 4, TEST_SOLVER_CONNECTION_CHANCE, seed, Tile_Map,
+                                                              Generation_Mode::Propagate);
+    D_Map d_map(layouts.front());
+    QImage preview = d_map.render_preview();
+
+    int y = 0;
+    for (uint16_t row = 0; row < d_map.get_rows(); row++)
+    {
+        int x = 0;
+        int height = d_map.get_tile(0, row)->get_image_level(TILE_PREVIEW_LEVEL).height();
+        for (uint16_t col = 0; col < d_map.get_cols(); col++)
+        {
+            QImage const &expected = d_map.get_tile(col, row)->get_image_level(TILE_PREVIEW_LEVEL);
+            //! NOTE: Solid tiles are filled rather than copied, their levels hold the same pixel.
+            if (preview.copy(x, y, expected.width(), expected.height()) != expected)
+                throw std::runtime_error(ERR_FORMAT(std::format("Preview cell {},{} differs from its tile!", col, row)));
+            x += expected.width();
+        }
+        if (x != preview.width())
+            throw std::runtime_error(ERR_FORMAT(std::format("Preview row {} is {} pixels wide, not {}!", row, x, preview.width())));
+        y += height;
+    }
+    if (y != preview.height())
+        throw std::runtime_error(ERR_FORMAT("Preview rows do not add up to its height!"));
+
+    LOG_INFO(std::format("{}x{} preview matched its tiles.", preview.width(), preview.height()));
+}
+
+/***********************************************************************************************************************
+ * @brief Checks that designs saved as map layouts reload with the same settings and tiles, and that truncated, damaged
+ * or foreign layouts are refused.
+ *
+ * @param[in] seed Seed of the first design.
+ *
+ * @throws std::runtime_error If a reloaded design differs or a bad layout was accepted.
+ **********************************************************************************************************************/
+void test_map_layouts(uint64_t seed)
+{
+    std::filesystem::create_directories(DEFAULT_TEST_OUTPUT_IMG_PATH);
+    size_t total_bytes = 0;
+    std::vector<D_Map_Layout> layouts;
+    for (Generation_Mode mode : {Generation_Mode::Greedy, Generation_Mode::Propagate})
+    {
+        std::vector<D_Map_Layout> batch = D_Map::generate_batch(TEST_LAYOUT_MAPS, TEST_REGION_MAP_SIZE,
+                                                                TEST_SOLVER_MAP_SIZE, TEST_SOLVER_CONNECTION_CHANCE,
+                                                                seed++, Tile_Map, mode);
+        layouts.insert(layouts.end(), batch.begin(), batch.end());
+    }
+
+    for (size_t idx = 0; idx < layouts.size(); idx++)
+    {
+        D_Map d_map(layouts[idx]);
+        std::string file_name = std::format("{}Layout_{}.dml", DEFAULT_TEST_OUTPUT_IMG_PATH, idx);
+        if (!d_map.save_layout(file_name))
+            throw std::runtime_error(ERR_FORMAT("Failed to save a test map layout!"));
+        total_bytes += std::filesystem::file_size(file_name);
+
+        D_Map_Layout loaded = D_Map::load_layout(file_name, Tile_Index);
+        if (loaded.cols != layouts[idx].cols || loaded.rows != layouts[idx].rows ||
+            loaded.connection_chance != layouts[idx].connection_chance || loaded.seed != layouts[idx].seed ||
+            loaded.generation_mode != layouts[idx].generation_mode || loaded.tiles != layouts[idx].tiles)
+            throw std::runtime_error(ERR_FORMAT(std::format("Map layout {} reloaded differently!", idx)));
+    }
+
+    // Cut short, a flipped tile set hash and a flipped body byte must all be refused.
+    std::vector<char> encoded = D_Map(layouts.front()).encode_layout();
+    std::vector<std::vector<char>> bad_layouts(3, encoded);
+    bad_layouts[0].pop_back();
+    bad_layouts[1][8] ^= 0x01;
+    bad_layouts[2].back() = static_cast<char>(0xFF);
+    for (std::vector<char> const &bad : bad_layouts)
+    {
+        bool accepted = true;
+        try
+        {
+            D_Map::decode_layout(reinterpret_cast<unsigned char const *>(bad.data()), bad.size(), Tile_Index);
+        }
+        catch (std::runtime_error const &)
+        {
+            accepted = false;
+        }
+        if (accepted)
+            throw std::runtime_error(ERR_FORMAT("A bad map layout was accepted!"));
+    }
+
+    LOG_INFO(std::format("{} map layouts reloaded, {:.1f} bytes per map.", layouts.size(),
+                         static_cast<double>(total_bytes) / static_cast<double>(layouts.size())));
+}
+
+/***********************************************************************************************************************
+ * @brief Runs jobs on the shared pool that each run more jobs on it, nested runs must finish inline rather than wait
+ * on their own busy workers.
+ *
+ * @throws std::runtime_error if a nested job was skipped or run twice.
+ **********************************************************************************************************************/
+void test_nested_pool_run()
+{
+    D_Thread_Pool &pool = D_Thread_Pool::shared();
+    size_t const outer_jobs = pool.size() * 2;
+    std::vector<std::atomic<size_t>> inner_counts(outer_jobs * 8);
+    pool.run(outer_jobs, [&](size_t outer_idx, [[maybe_unused]] size_t worker_idx)
+             { pool.run(8, [&](size_t inner_idx, [[maybe_unused]] size_t inner_worker_idx)
+                        { inner_counts[outer_idx * 8 + inner_idx]++; }); });
+
+    for (std::atomic<size_t> const &count : inner_counts)
+    {
+        if (1 != count.load())
+            throw std::runtime_error(ERR_FORMAT("Nested pool run skipped or repeated a job!"));
     }
-    LOG_DEBUG(std::format("Ending thread[{}]", t_number));
+    LOG_INFO(std::format("Nested pool runs completed {} jobs.", inner_counts.size()));
 }
 
 int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
@@ -128,39 +874,27 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char **argv)
     std::filesystem::path img_dir(DEFAULT_INPUT_IMG_PATH);
     std::filesystem::path loaded_dir(DEFAULT_SECTION_IMG_LOADED_PATH);
 
-    D_Tile::load_tiles(img_dir, loaded_dir);
+    //! NOTE: Only the tiles placed in generated maps are ever decoded.
+    D_Tile::load_tiles(img_dir, loaded_dir, Image_Load_Mode::Lazy);
     D_Tile::generate_tiles();
 
-    Used_Tiles.reserve(Tile_Map.size());
+    Used_Tile_Words = std::vector<std::atomic<uint64_t>>(Tile_Index->get_word_count());
 
-    // Start up some threads to run generations
-    unsigned int t = std::thread::hardware_concurrency();
-    if (t == 0)
-    {
-        LOG_DEBUG("Unable to detect available thread count, defaulting to 4.");
-        t = 4;
-    }
-    else
-    {
-        LOG_DEBUG(std::format("Assuming {} available threads.", t));
-    }
-
-    LOG_DEBUG("Launching generation threads...");
-    std::vector<std::thread> thread_pool;
-    for (size_t i = 0; i < t; i++)
-    {
-        thread_pool.emplace_back(test_generations, i);
-    }
+    test_nested_pool_run();
+    test_seeded_generation(std::random_device{}());
+    test_propagate_generation(std::random_device{}());
+    test_region_generation(std::random_device{}());
+    test_incremental_render(std::random_device{}());
+    test_streamed_render(std::random_device{}());
+    test_lossless_encoders(std::random_device{}());
+    test_pyramid(std::random_device{}());
+    test_preview(std::random_device{}());
+    test_map_layouts(std::random_device{}());
+    test_tile_handle_throughput(std::random_device{}());
 
-    LOG_DEBUG("Awaiting generation termination...");
-    for (auto &thread : thread_pool)
-    {
-        if (thread.joinable())
-        {
-            thread.join();
-        }
-    }
-    LOG_DEBUG(std::format("Generation threads rejoined. {}/{} Tiles Used", Used_Tiles.size(), Tile_Map.size()));
+    LOG_INFO(std::format("Generating in batches across {} threads...", D_Thread_Pool::shared().size()));
+    test_generations(std::random_device{}());
+    LOG_INFO(std::format("Generation complete. {} maps, {}/{} Tiles Used", G, count_used_tiles(), Tile_Index->size()));
 
     return EXIT_SUCCESS;
 }
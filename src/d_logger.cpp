@@ -0,0 +1,325 @@
+/***********************************************************************************************************************
+ * @date 2026-10-16
+ * @author Gregory Nitch
+ *
+ * @brief D_Logger implementation functions.
+ **********************************************************************************************************************/
+
+/*
+========================================================================================================================
+- - System Includes - -
+========================================================================================================================
+*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <array>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <algorithm>
+#include <string_view>
+
+/*
+========================================================================================================================
+- - Local Includes - -
+========================================================================================================================
+*/
+
+#include "d_logger.hpp"
+
+/*
+========================================================================================================================
+- - Local Constants - -
+========================================================================================================================
+*/
+
+static_assert(!(LOG_RING_SIZE & (LOG_RING_SIZE - 1)), "LOG_RING_SIZE must be a power of two");
+
+static constexpr std::array<std::string_view, LOG_LEVEL_OFF> LOG_LEVEL_TAGS = {"TRC", "DBG", "INF", "WRN", "ERR"};
+
+/*
+========================================================================================================================
+- - Static Members - -
+========================================================================================================================
+*/
+
+std::atomic<uint8_t> D_Logger::runtime_level = LOG_LEVEL_DEBUG;
+std::terminate_handler D_Logger::previous_terminate = nullptr;
+std::atomic<uint64_t> D_Logger::next_sequence = 0;
+
+/*
+========================================================================================================================
+- - Class Methods - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Destructor for the D_Logger, stops the writer thread once every ring has been drained.
+ **********************************************************************************************************************/
+D_Logger::~D_Logger()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    wake_cv.notify_all();
+
+    if (writer.joinable())
+        writer.join();
+}
+
+/***********************************************************************************************************************
+ * @brief Checks if a level is currently written, used by LOG_AT before building the message.
+ *
+ * @param[in] level Level to check.
+ *
+ * @retval bool True if records at the level are written.
+ **********************************************************************************************************************/
+bool D_Logger::enabled(Log_Level level)
+{
+    return static_cast<uint8_t>(level) >= runtime_level.load(std::memory_order_relaxed);
+}
+
+/***********************************************************************************************************************
+ * @brief Sets the lowest level written at runtime, levels below D_LOG_COMPILE_LEVEL stay compiled out regardless.
+ *
+ * @param[in] level Lowest level to write, Log_Level::Off disables logging.
+ **********************************************************************************************************************/
+void D_Logger::set_level(Log_Level level)
+{
+    runtime_level.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the lowest level written at runtime.
+ *
+ * @retval Log_Level The current runtime level.
+ **********************************************************************************************************************/
+Log_Level D_Logger::get_level()
+{
+    return static_cast<Log_Level>(runtime_level.load(std::memory_order_relaxed));
+}
+
+/***********************************************************************************************************************
+ * @brief Queues a record on the calling thread's ring for the writer thread. Normally called through the LOG_* macros.
+ *
+ * @param[in] level Level of the record.
+ * @param[in] file Source file name, must outlive the logger ie __FILE__.
+ * @param[in] func Function name, must outlive the logger ie __func__.
+ * @param[in] line Source line.
+ * @param[in] msg Message of the record.
+ *
+ * @note Waits for the writer when the ring is full rather than dropping the record.
+ **********************************************************************************************************************/
+void D_Logger::write(Log_Level level, char const *file, char const *func, int line, std::string msg)
+{
+    Log_Ring &ring = thread_ring();
+    size_t head = ring.head.load(std::memory_order_relaxed);
+    while (head - ring.tail.load(std::memory_order_acquire) >= LOG_RING_SIZE)
+    {
+        instance().wake_writer();
+        std::this_thread::yield();
+    }
+
+    Log_Record &record = ring.records[head & (LOG_RING_SIZE - 1)];
+    record.sequence = next_sequence.fetch_add(1, std::memory_order_relaxed);
+    record.level = level;
+    record.file = file;
+    record.func = func;
+    record.line = line;
+    record.msg = std::move(msg);
+    ring.head.store(head + 1, std::memory_order_release);
+
+    //! NOTE: Only wake the writer early for errors or a filling ring, otherwise it drains on its interval.
+    if (Log_Level::Error <= level ||
+        LOG_RING_SIZE / 2 == head + 1 - ring.tail.load(std::memory_order_relaxed))
+    {
+        instance().wake_writer();
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Blocks until every record queued before the call has been written, ie before printing to std::cerr or exiting
+ * on an error.
+ **********************************************************************************************************************/
+void D_Logger::flush()
+{
+    D_Logger &logger = instance();
+    std::unique_lock<std::mutex> lock(logger.mtx);
+    uint64_t target = logger.drains_started + 1; // A drain that starts after this call
+    logger.wake_requested = true;
+    logger.wake_cv.notify_all();
+    logger.drained_cv.wait(lock, [&]()
+                           { return logger.drains_done >= target; });
+}
+
+/*
+========================================================================================================================
+- - Private Functions - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Constructor for the D_Logger, starts the writer thread and hooks std::terminate so records queued before an
+ * uncaught exception are still written.
+ **********************************************************************************************************************/
+D_Logger::D_Logger()
+{
+    writer = std::thread(&D_Logger::writer_loop, this);
+    previous_terminate = std::set_terminate(&D_Logger::on_terminate);
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the process wide logger, started on first use.
+ *
+ * @retval D_Logger The logger.
+ *
+ * @warning Logging from static destructors that run after the logger's is not supported.
+ **********************************************************************************************************************/
+D_Logger &D_Logger::instance()
+{
+    static D_Logger logger;
+    return logger;
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the calling thread's ring, registering a new one with the logger on the thread's first record.
+ *
+ * @retval Log_Ring The calling thread's ring.
+ **********************************************************************************************************************/
+D_Logger::Log_Ring &D_Logger::thread_ring()
+{
+    thread_local Ring_Owner owner;
+    if (!owner.ring)
+    {
+        owner.ring = std::make_shared<Log_Ring>();
+        D_Logger &logger = instance();
+        std::lock_guard<std::mutex> lock(logger.mtx);
+        logger.rings.push_back(owner.ring);
+    }
+    return *owner.ring;
+}
+
+/***********************************************************************************************************************
+ * @brief Terminate handler, flushes the queued records and then hands over to the previous handler.
+ **********************************************************************************************************************/
+void D_Logger::on_terminate()
+{
+    flush();
+    if (previous_terminate)
+        previous_terminate();
+    std::abort();
+}
+
+/***********************************************************************************************************************
+ * @brief Destructor for a Ring_Owner, runs on thread exit and retires the ring so the writer drops it once drained.
+ **********************************************************************************************************************/
+D_Logger::Ring_Owner::~Ring_Owner()
+{
+    if (ring)
+        ring->retired.store(true, std::memory_order_release);
+}
+
+/***********************************************************************************************************************
+ * @brief Wakes the writer thread to drain without waiting out LOG_DRAIN_INTERVAL_MS.
+ **********************************************************************************************************************/
+void D_Logger::wake_writer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        wake_requested = true;
+    }
+    wake_cv.notify_one();
+}
+
+/***********************************************************************************************************************
+ * @brief Main loop of the writer thread, drains every ring on each wake or interval until stopped and empty.
+ **********************************************************************************************************************/
+void D_Logger::writer_loop()
+{
+    std::string out;
+    for (;;)
+    {
+        uint64_t drain_id = 0;
+        bool stop = false;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            wake_cv.wait_for(lock, std::chrono::milliseconds(LOG_DRAIN_INTERVAL_MS), [this]()
+                             { return wake_requested || stopping; });
+            wake_requested = false;
+            stop = stopping;
+            drain_id = ++drains_started;
+        }
+
+        bool drained_any = drain(out);
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            drains_done = drain_id;
+        }
+        drained_cv.notify_all();
+
+        if (stop && !drained_any)
+            return;
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Formats and writes every queued record in sequence order with a single flush, then drops retired rings that
+ * are empty.
+ *
+ * @param[inout] out Buffer to format records into, reused between drains.
+ *
+ * @retval bool True if any records were written.
+ **********************************************************************************************************************/
+bool D_Logger::drain(std::string &out)
+{
+    std::vector<std::shared_ptr<Log_Ring>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        snapshot = rings;
+    }
+
+    std::vector<Log_Record *> pending;
+    std::vector<size_t> heads(snapshot.size(), 0);
+    for (size_t ring_idx = 0; ring_idx < snapshot.size(); ring_idx++)
+    {
+        Log_Ring &ring = *snapshot[ring_idx];
+        heads[ring_idx] = ring.head.load(std::memory_order_acquire);
+        for (size_t tail = ring.tail.load(std::memory_order_relaxed); tail != heads[ring_idx]; tail++)
+            pending.push_back(&ring.records[tail & (LOG_RING_SIZE - 1)]);
+    }
+
+    std::sort(pending.begin(), pending.end(), [](Log_Record const *a, Log_Record const *b)
+              { return a->sequence < b->sequence; });
+    for (Log_Record *record : pending)
+    {
+        out += std::format("{}:{}:{}:{}:{}\n",
+                           LOG_LEVEL_TAGS[static_cast<uint8_t>(record->level)],
+                           record->file,
+                           record->func,
+                           record->line,
+                           record->msg);
+        record->msg.clear();
+    }
+
+    for (size_t ring_idx = 0; ring_idx < snapshot.size(); ring_idx++)
+        snapshot[ring_idx]->tail.store(heads[ring_idx], std::memory_order_release);
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::erase_if(rings, [](std::shared_ptr<Log_Ring> const &ring)
+                      { return ring->retired.load(std::memory_order_acquire) &&
+                               ring->head.load(std::memory_order_acquire) ==
+                                   ring->tail.load(std::memory_order_relaxed); });
+    }
+
+    if (out.empty())
+        return false;
+
+    std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+    std::cout.flush();
+    out.clear();
+    return true;
+}
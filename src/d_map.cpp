@@ -12,6 +12,7 @@
 */
 
 #include <cstdint>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -20,6 +21,14 @@
 #include <format>
 #include <unordered_map>
 #include <algorithm>
+#include <bit>
+#include <array>
+#include <functional>
+#include <fstream>
+#include <filesystem>
+#include <atomic>
+#include <stdexcept>
+#include <cstddef>
 
 /*
 ========================================================================================================================
@@ -28,7 +37,8 @@
 */
 
 #include <QImage>
-#include <QPainter>
+#include <QImageWriter>
+#include <QFile>
 #include <QString>
 
 /*
@@ -38,6 +48,8 @@
 */
 
 #include "d_map.hpp"
+#include "d_tile_index.hpp"
+#include "d_thread_pool.hpp"
 #include "d_builder_common.hpp"
 
 /*
@@ -47,15 +59,71 @@
 */
 
 /***********************************************************************************************************************
- * @brief Max map size in both width and height, ie. 20x20.
+ * @brief Max map size in both width and height, ie. 4096x4096.
  **********************************************************************************************************************/
-#define MAX_MAP_SIZE (20)
+#define MAX_MAP_SIZE (4096)
 
 /***********************************************************************************************************************
  * @brief Min map size in both width and height, ie. 2x2.
  **********************************************************************************************************************/
 #define MIN_MAP_SIZE (2)
 
+/***********************************************************************************************************************
+ * @brief Magic bytes at the start of a map layout file, 'DMAP'.
+ **********************************************************************************************************************/
+#define MAP_LAYOUT_MAGIC (0x5041'4D44U)
+
+/***********************************************************************************************************************
+ * @brief Version of the map layout file, bump this whenever the header or body encoding change.
+ **********************************************************************************************************************/
+#define MAP_LAYOUT_VERSION (1U)
+
+/***********************************************************************************************************************
+ * @brief Token bit of a map layout body token that is followed by a run length, ie the palette entry repeats.
+ **********************************************************************************************************************/
+#define MAP_LAYOUT_RUN_BIT (0x01U)
+
+/*
+========================================================================================================================
+- - Map Layout File - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Header at the start of a map layout file. The file is laid out as the header, then palette_count uint16_t tile
+ * handles ordered from most to least used, then body_bytes of tokens. Cells are read in row major order, each token is
+ * an unsigned LEB128 varint of (palette index << 1 | MAP_LAYOUT_RUN_BIT if repeated) and a repeated token is followed by
+ * a varint of the run length minus 2. Frequent tiles, ie the Empty_Tile, so take one byte per run or cell.
+ *
+ * @members :
+ *      @public uint32_t magic = MAP_LAYOUT_MAGIC.
+ *      @public uint32_t version = MAP_LAYOUT_VERSION.
+ *      @public uint64_t tile_index_hash = Hash of the tile index the handles refer to. @see D_Tile_Index::get_hash()
+ *      @public uint64_t seed = Seed the design was generated from.
+ *      @public uint16_t cols = Width of the map.
+ *      @public uint16_t rows = Height of the map.
+ *      @public uint8_t connection_chance = Connection chance the design was generated with.
+ *      @public uint8_t generation_mode = Generation_Mode value the design was generated in.
+ *      @public uint16_t palette_count = Number of distinct tile handles in the design.
+ *      @public uint32_t body_bytes = Bytes of tokens after the palette.
+ *      @public uint32_t reserved = Padding, always zero.
+ **********************************************************************************************************************/
+struct Map_Layout_Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t tile_index_hash;
+    uint64_t seed;
+    uint16_t cols;
+    uint16_t rows;
+    uint8_t connection_chance;
+    uint8_t generation_mode;
+    uint16_t palette_count;
+    uint32_t body_bytes;
+    uint32_t reserved;
+};
+static_assert(sizeof(Map_Layout_Header) == 40, "Map layout header changed, bump MAP_LAYOUT_VERSION!");
+
 /*
 ========================================================================================================================
 - - Class Methods - -
@@ -70,17 +138,82 @@
  * @param[in] in_con_chance Percentage chance for tiles to connect to each other during generation.
  * @param[in] usable_tiles Map of tiles to use during generation, defaults to the default map of tiles.
  **********************************************************************************************************************/
-D_Map::D_Map(uint8_t in_cols,
-             uint8_t in_rows,
+D_Map::D_Map(uint16_t in_cols,
+             uint16_t in_rows,
              uint8_t in_con_chance,
              std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles = Tile_Map)
+    : D_Map(in_cols, in_rows, in_con_chance, usable_tiles, Deferred_Generate{})
+{
+    std::random_device rd;
+    generate((static_cast<uint64_t>(rd()) << 32) | rd());
+}
+
+/***********************************************************************************************************************
+ * @brief Constructor for D_Map with an explicit seed, creates the D_Map object and generates the design for that seed.
+ * The same tile set, size, connection chance and seed always produce the same design.
+ *
+ * @param[in] in_cols The width of the map.
+ * @param[in] in_rows The height of the map.
+ * @param[in] in_con_chance Percentage chance for tiles to connect to each other during generation.
+ * @param[in] usable_tiles Map of tiles to use during generation.
+ * @param[in] in_seed Seed to generate the design from.
+ **********************************************************************************************************************/
+D_Map::D_Map(uint16_t in_cols,
+             uint16_t in_rows,
+             uint8_t in_con_chance,
+             std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles,
+             uint64_t in_seed)
+    : D_Map(in_cols, in_rows, in_con_chance, usable_tiles, Deferred_Generate{})
+{
+    generate(in_seed);
+}
+
+/***********************************************************************************************************************
+ * @brief Constructor for D_Map from a detached layout, adopts the layout's design without generating.
+ *
+ * @param[in] layout Layout to adopt, ie one returned by generate_batch().
+ *
+ * @throws std::invalid_argument if the layout has no tile index or its grid does not match its size.
+ **********************************************************************************************************************/
+D_Map::D_Map(D_Map_Layout const &layout)
+{
+    if (!layout.tile_index || layout.tiles.size() != static_cast<size_t>(layout.cols) * layout.rows)
+        throw std::invalid_argument(ERR_FORMAT("Invalid layout given to D_Map!"));
+
+    cols = layout.cols;
+    rows = layout.rows;
+    connection_chance = layout.connection_chance;
+    seed = layout.seed;
+    generation_mode = layout.generation_mode;
+    tile_index = layout.tile_index;
+    tile_grid = layout.tiles;
+    canidate_words.assign(tile_index->get_word_count(), 0);
+    reseed(layout.seed);
+}
+
+/***********************************************************************************************************************
+ * @brief Constructor for D_Map that only validates and stores the settings, the design is left empty until the caller
+ * generates one.
+ *
+ * @param[in] in_cols The width of the map.
+ * @param[in] in_rows The height of the map.
+ * @param[in] in_con_chance Percentage chance for tiles to connect to each other during generation.
+ * @param[in] usable_tiles Map of tiles to use during generation.
+ **********************************************************************************************************************/
+D_Map::D_Map(uint16_t in_cols,
+             uint16_t in_rows,
+             uint8_t in_con_chance,
+             std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles,
+             Deferred_Generate)
 {
     if (in_cols > MAX_MAP_SIZE ||
         in_rows > MAX_MAP_SIZE ||
         in_cols < MIN_MAP_SIZE ||
         in_rows < MIN_MAP_SIZE)
     {
-        throw std::invalid_argument(ERR_FORMAT("Invalid sizes given to D_Map: Sizes must be between 2-20 inclusive!"));
+        throw std::invalid_argument(ERR_FORMAT(std::format("Invalid sizes given to D_Map: Sizes must be between {}-{} inclusive!",
+                                                           MIN_MAP_SIZE,
+                                                           MAX_MAP_SIZE)));
     }
     if (usable_tiles.empty())
     {
@@ -90,10 +223,7 @@ D_Map::D_Map(uint8_t in_cols,
     cols = in_cols;
     rows = in_rows;
     connection_chance = in_con_chance;
-    theme_map = usable_tiles;
-    gen.seed(rd());
-
-    generate();
+    set_tile_index(usable_tiles);
 }
 
 D_Map::~D_Map()
@@ -102,20 +232,345 @@ D_Map::~D_Map()
 }
 
 /***********************************************************************************************************************
- * @brief Generates a new map design for the map using the currently set settings and tile map.
+ * @brief Generates a batch of map designs across the shared thread pool. Each worker reuses one D_Map's scratch state
+ * for every map it generates and writes its results straight into its own slots of the batch, so no locks are taken
+ * per map.
+ *
+ * @param[in] count Number of maps to generate.
+ * @param[in] in_cols The width of each map.
+ * @param[in] in_rows The height of each map.
+ * @param[in] in_con_chance Percentage chance for tiles to connect to each other during generation.
+ * @param[in] seed Seed of the batch, map i is generated from a seed derived from this seed and i.
+ * @param[in] usable_tiles Map of tiles to use during generation, defaults to the default map of tiles.
+ * @param[in] mode Generation mode of every map, defaults to Greedy.
+ *
+ * @retval std::vector<D_Map_Layout> The generated layouts, in batch order.
+ *
+ * @note A map that hits a dead end is regenerated from the next derived seed, the seed actually used is recorded in
+ * its layout. Maps generated in the Propagate mode do not hit dead ends.
+ *
+ * @throws std::runtime_error if a map hits a dead end MAP_BATCH_MAX_ATTEMPTS times in a row.
+ **********************************************************************************************************************/
+std::vector<D_Map_Layout> D_Map::generate_batch(size_t count,
+                                                uint16_t in_cols,
+                                                uint16_t in_rows,
+                                                uint8_t in_con_chance,
+                                                uint64_t seed,
+                                                std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles = Tile_Map,
+                                                Generation_Mode mode = Generation_Mode::Greedy)
+{
+    std::vector<D_Map_Layout> layouts(count);
+    if (!count)
+        return layouts;
+
+    D_Thread_Pool &pool = D_Thread_Pool::shared();
+
+    // Validate the settings and build the tile index once, each worker then copies this map as its scratch state.
+    D_Map prototype(in_cols, in_rows, in_con_chance, usable_tiles, Deferred_Generate{});
+    prototype.set_generation_mode(mode);
+    std::vector<std::unique_ptr<D_Map>> worker_maps(pool.size());
+
+    pool.run(count, [&](size_t job_idx, size_t worker_idx)
+             {
+                 std::unique_ptr<D_Map> &d_map = worker_maps[worker_idx];
+                 if (!d_map)
+                     d_map = std::make_unique<D_Map>(prototype);
+
+                 for (uint64_t attempt = 0; attempt < MAP_BATCH_MAX_ATTEMPTS; attempt++)
+                 {
+                     //! NOTE: Seeds are a simple hash of (batch seed, index, attempt) so every item is independent.
+                     uint64_t item_key[3] = {seed, static_cast<uint64_t>(job_idx), attempt};
+                     try
+                     {
+                         d_map->generate(fnv1a_64(item_key, sizeof(item_key)));
+                     }
+                     catch (std::runtime_error const &)
+                     {
+                         continue;
+                     }
+
+                     layouts[job_idx] = d_map->get_layout();
+                     return;
+                 }
+
+                 throw std::runtime_error(ERR_FORMAT(std::format("Batch map {} hit a dead end {} times in a row!",
+                                                                 job_idx,
+                                                                 MAP_BATCH_MAX_ATTEMPTS))); });
+
+    return layouts;
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the current design of the map as a detached layout.
+ *
+ * @retval D_Map_Layout The map's settings, seed and tile grid.
+ **********************************************************************************************************************/
+D_Map_Layout D_Map::get_layout() const
+{
+    return {
+        .cols = cols,
+        .rows = rows,
+        .connection_chance = connection_chance,
+        .seed = seed,
+        .generation_mode = generation_mode,
+        .tile_index = tile_index,
+        .tiles = tile_grid,
+    };
+}
+
+/***********************************************************************************************************************
+ * @brief Encodes the current map design in the compact map layout format, ie a palette of the design's tile handles
+ * followed by run length tokens. Only the design and the settings that made it are kept, no pixels. @see
+ * Map_Layout_Header
+ *
+ * @retval std::vector<char> The encoded layout, eg to write to a file or pack into an archive.
+ **********************************************************************************************************************/
+std::vector<char> D_Map::encode_layout() const
+{
+    // Palette from most to least used handle, so the commonest tiles get the shortest tokens.
+    std::unordered_map<uint16_t, uint32_t> handle_counts;
+    for (uint16_t handle : tile_grid)
+        handle_counts[handle]++;
+    std::vector<std::pair<uint16_t, uint32_t>> palette(handle_counts.begin(), handle_counts.end());
+    std::sort(palette.begin(), palette.end(), [](auto const &lhs, auto const &rhs)
+              { return lhs.second != rhs.second ? lhs.second > rhs.second : lhs.first < rhs.first; });
+    std::unordered_map<uint16_t, uint32_t> palette_idx;
+    for (size_t idx = 0; idx < palette.size(); idx++)
+        palette_idx[palette[idx].first] = static_cast<uint32_t>(idx);
+
+    std::vector<char> body;
+    auto push_varint = [&body](uint32_t value)
+    {
+        while (value >= 0x80)
+        {
+            body.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        body.push_back(static_cast<char>(value));
+    };
+    for (size_t cell = 0; cell < tile_grid.size();)
+    {
+        size_t run = 1;
+        while (cell + run < tile_grid.size() && tile_grid[cell + run] == tile_grid[cell])
+            run++;
+        uint32_t const token = palette_idx[tile_grid[cell]] << 1;
+        if (run > 1)
+        {
+            push_varint(token | MAP_LAYOUT_RUN_BIT);
+            push_varint(static_cast<uint32_t>(run - 2));
+        }
+        else
+        {
+            push_varint(token);
+        }
+        cell += run;
+    }
+
+    Map_Layout_Header header = {
+        .magic = MAP_LAYOUT_MAGIC,
+        .version = MAP_LAYOUT_VERSION,
+        .tile_index_hash = tile_index ? tile_index->get_hash() : 0,
+        .seed = seed,
+        .cols = cols,
+        .rows = rows,
+        .connection_chance = connection_chance,
+        .generation_mode = static_cast<uint8_t>(generation_mode),
+        .palette_count = static_cast<uint16_t>(palette.size()),
+        .body_bytes = static_cast<uint32_t>(body.size()),
+        .reserved = 0,
+    };
+    std::vector<char> out(sizeof(header) + palette.size() * sizeof(uint16_t) + body.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+    for (size_t idx = 0; idx < palette.size(); idx++)
+        std::memcpy(out.data() + sizeof(header) + idx * sizeof(uint16_t), &palette[idx].first, sizeof(uint16_t));
+    size_t const body_offset = sizeof(header) + palette.size() * sizeof(uint16_t);
+    std::copy(body.begin(), body.end(), out.begin() + static_cast<std::ptrdiff_t>(body_offset));
+    return out;
+}
+
+/***********************************************************************************************************************
+ * @brief Saves the current map design as a map layout file, which D_Map::load_layout() reopens without regenerating.
+ * @see encode_layout()
+ *
+ * @param[in] file_name File name (and path) to save to.
+ *
+ * @retval bool Wether or not the save was succesful.
+ **********************************************************************************************************************/
+bool D_Map::save_layout(std::string file_name) const
+{
+    std::vector<char> out = encode_layout();
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+/***********************************************************************************************************************
+ * @brief Decodes a map design encoded by encode_layout(), checking every field so a damaged or foreign layout throws
+ * rather than giving a map with bad handles. Construct a D_Map from the result to render it.
+ *
+ * @param[in] data First byte of the encoded layout.
+ * @param[in] size Bytes of encoded layout, trailing bytes are not allowed.
+ * @param[in] tile_index Index the layout's tile handles refer to, ie the global Tile_Index of the catalog it was saved
+ * with.
+ *
+ * @retval D_Map_Layout The decoded design.
+ *
+ * @throws std::invalid_argument If the tile index is null.
+ * @throws std::runtime_error If the layout is damaged, from another version or was saved with another tile set.
+ **********************************************************************************************************************/
+D_Map_Layout D_Map::decode_layout(unsigned char const *data,
+                                  size_t size,
+                                  std::shared_ptr<D_Tile_Index const> tile_index)
+{
+    if (!tile_index)
+        throw std::invalid_argument(ERR_FORMAT("Given a null tile index to decode a map layout with!"));
+
+    Map_Layout_Header header;
+    if (!data || size < sizeof(header))
+        throw std::runtime_error(ERR_FORMAT("Map layout is too short!"));
+    std::memcpy(&header, data, sizeof(header));
+    if (MAP_LAYOUT_MAGIC != header.magic || MAP_LAYOUT_VERSION != header.version)
+        throw std::runtime_error(ERR_FORMAT("Map layout is from another version or not a map layout!"));
+    if (tile_index->get_hash() != header.tile_index_hash)
+        throw std::runtime_error(ERR_FORMAT("Map layout was saved with another tile set!"));
+    if (header.cols < MIN_MAP_SIZE || header.cols > MAX_MAP_SIZE || header.rows < MIN_MAP_SIZE ||
+        header.rows > MAX_MAP_SIZE || header.connection_chance > ONE_HUNDRED_PERCENT ||
+        header.generation_mode > static_cast<uint8_t>(Generation_Mode::Propagate) || !header.palette_count ||
+        sizeof(header) + header.palette_count * sizeof(uint16_t) + header.body_bytes != size)
+        throw std::runtime_error(ERR_FORMAT("Map layout header is damaged!"));
+
+    std::vector<uint16_t> palette(header.palette_count);
+    std::memcpy(palette.data(), data + sizeof(header), palette.size() * sizeof(uint16_t));
+    for (uint16_t handle : palette)
+    {
+        if (handle >= tile_index->size() && MAP_EMPTY_TILE_HANDLE != handle && MAP_UNSET_TILE_HANDLE != handle)
+            throw std::runtime_error(ERR_FORMAT(std::format("Map layout palette has unknown tile handle {}!", handle)));
+    }
+
+    unsigned char const *pos = data + sizeof(header) + palette.size() * sizeof(uint16_t);
+    unsigned char const *const end = data + size;
+    auto read_varint = [&pos, end]()
+    {
+        uint32_t value = 0;
+        for (int shift = 0; shift < 32; shift += 7)
+        {
+            if (pos == end)
+                throw std::runtime_error(ERR_FORMAT("Map layout body ends mid token!"));
+            unsigned char const byte = *pos++;
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        throw std::runtime_error(ERR_FORMAT("Map layout body has an overlong token!"));
+    };
+
+    D_Map_Layout layout = {
+        .cols = header.cols,
+        .rows = header.rows,
+        .connection_chance = header.connection_chance,
+        .seed = header.seed,
+        .generation_mode = static_cast<Generation_Mode>(header.generation_mode),
+        .tile_index = std::move(tile_index),
+        .tiles = {},
+    };
+    size_t const cell_count = static_cast<size_t>(header.cols) * header.rows;
+    layout.tiles.reserve(cell_count);
+    while (pos != end)
+    {
+        uint32_t const token = read_varint();
+        size_t const run = (token & MAP_LAYOUT_RUN_BIT) ? static_cast<size_t>(read_varint()) + 2 : 1;
+        if ((token >> 1) >= palette.size() || run > cell_count - layout.tiles.size())
+            throw std::runtime_error(ERR_FORMAT("Map layout body is damaged!"));
+        layout.tiles.insert(layout.tiles.end(), run, palette[token >> 1]);
+    }
+    if (layout.tiles.size() != cell_count)
+        throw std::runtime_error(ERR_FORMAT("Map layout body does not cover the map!"));
+
+    return layout;
+}
+
+/***********************************************************************************************************************
+ * @brief Loads a map design from a map layout file, the file is memory mapped and decoded in place so reopening a
+ * design costs little more than reading its few bytes. @see decode_layout()
+ *
+ * @param[in] file_path Path of a file written by save_layout().
+ * @param[in] tile_index Index the layout's tile handles refer to, ie the global Tile_Index.
+ *
+ * @retval D_Map_Layout The saved design.
+ *
+ * @throws std::runtime_error If the file cannot be opened or mapped, or its layout cannot be decoded.
+ **********************************************************************************************************************/
+D_Map_Layout D_Map::load_layout(std::filesystem::path const &file_path, std::shared_ptr<D_Tile_Index const> tile_index)
+{
+    QFile layout_file(QString::fromStdString(file_path.generic_string()));
+    if (!layout_file.open(QFile::ReadOnly))
+        throw std::runtime_error(ERR_FORMAT(std::format("Unable to open map layout {}!", file_path.generic_string())));
+
+    size_t const file_size = static_cast<size_t>(layout_file.size());
+    unsigned char *mapped = file_size ? layout_file.map(0, layout_file.size()) : nullptr;
+    if (!mapped)
+        throw std::runtime_error(ERR_FORMAT(std::format("Unable to map map layout {}!", file_path.generic_string())));
+
+    try
+    {
+        D_Map_Layout layout = decode_layout(mapped, file_size, std::move(tile_index));
+        layout_file.unmap(mapped);
+        return layout;
+    }
+    catch (...)
+    {
+        layout_file.unmap(mapped);
+        throw;
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Generates a new map design for the map using the currently set settings and tile map. The seed of the new
+ * design is drawn from the previous one, so a run of generate() calls is reproducible from the first seed.
  **********************************************************************************************************************/
 void D_Map::generate()
 {
-    LOG_DEBUG("Generate Start...");
+    uint64_t next_seed = static_cast<uint64_t>(gen()) << 32;
+    next_seed |= gen();
+    generate(next_seed);
+}
+
+/***********************************************************************************************************************
+ * @brief Generates the map design for the given seed using the currently set settings and tile map. The same tile set,
+ * size, connection chance, generation mode and seed always produce the same design.
+ *
+ * @param[in] in_seed Seed to generate the design from, @see get_seed().
+ *
+ * @throws std::runtime_error if a Greedy generation hits a dead end, or a Propagate generation finds the tile set
+ * cannot fill the map.
+ **********************************************************************************************************************/
+void D_Map::generate(uint64_t in_seed)
+{
+    reseed(in_seed);
+    LOG_TRACE("Generate Start...");
     reset_for_generate();
-    LOG_DEBUG("Map Reset...");
-    start_generation_at_entrance();
-    LOG_DEBUG("Entrance Placed...");
-    place_nodes();
-    LOG_DEBUG("Node Placement complete...");
+    LOG_TRACE("Map Reset...");
+    if (Generation_Mode::Propagate == generation_mode)
+    {
+        solver.window_col = 0;
+        solver.window_row = 0;
+        solver.window_cols = cols;
+        solver.window_rows = rows;
+        solve_constraints(true);
+        LOG_TRACE("Constraints solved...");
+    }
+    else
+    {
+        start_generation_at_entrance();
+        LOG_TRACE("Entrance Placed...");
+        place_nodes();
+        LOG_TRACE("Node Placement complete...");
+    }
     fill_empty_tiles();
-    LOG_DEBUG("Filled empty tiles...");
-    LOG_DEBUG(to_string());
+    LOG_TRACE("Filled empty tiles...");
+    mark_all_dirty();
+    LOG_TRACE(to_string());
+    LOG_DEBUG(std::format("Generated {}x{} map from seed {}.", cols, rows, seed));
 }
 
 /***********************************************************************************************************************
@@ -126,8 +581,8 @@ void D_Map::generate()
  * @param[in] in_con_chance New percentage chance of connections when generating designs.
  * @param[in] usable_tiles New map of tiles to use during generation.
  **********************************************************************************************************************/
-void D_Map::generate(uint8_t in_cols,
-                     uint8_t in_rows,
+void D_Map::generate(uint16_t in_cols,
+                     uint16_t in_rows,
                      uint8_t in_con_chance,
                      std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles = Tile_Map)
 {
@@ -136,7 +591,9 @@ void D_Map::generate(uint8_t in_cols,
         in_cols < MIN_MAP_SIZE ||
         in_rows < MIN_MAP_SIZE)
     {
-        throw std::invalid_argument(ERR_FORMAT("Invalid sizes given to D_Map::generate(): Sizes must be between 2-20 inclusive!"));
+        throw std::invalid_argument(ERR_FORMAT(std::format("Invalid sizes given to D_Map::generate(): Sizes must be between {}-{} inclusive!",
+                                                           MIN_MAP_SIZE,
+                                                           MAX_MAP_SIZE)));
     }
     if (usable_tiles.empty())
     {
@@ -146,51 +603,614 @@ void D_Map::generate(uint8_t in_cols,
     cols = in_cols;
     rows = in_rows;
     connection_chance = in_con_chance;
-    theme_map = usable_tiles;
+    set_tile_index(usable_tiles);
     generate();
 }
 
 /***********************************************************************************************************************
- * @brief Saves the current map design as an image to the given file name (and path).
+ * @brief Composites the current map design into the map's canvas and returns it. The canvas is kept between calls and
+ * only cells marked dirty since the last render whose tile differs from the one drawn are redrawn, the whole canvas is
+ * only rebuilt when the map's size or pixel layout changes. Larger redraws are split into bands of rows drawn across
+ * the shared thread pool. @see draw_cell()
+ *
+ * @retval QImage The composited design, valid until the map is next rendered or destroyed. Can be shown directly, ie
+ * QPixmap::fromImage(), without encoding.
+ **********************************************************************************************************************/
+QImage const &D_Map::render()
+{
+    std::vector<int> col_x;
+    std::vector<int> row_y;
+    measure_pixel_layout(col_x, row_y);
+
+    if (canvas.isNull() || canvas_grid.size() != tile_grid.size() || col_x != canvas_col_x || row_y != canvas_row_y)
+    {
+        canvas = QImage(col_x.back(), row_y.back(), TILE_IMAGE_FORMAT);
+        canvas.fill(Qt::transparent);
+        canvas_grid.assign(tile_grid.size(), MAP_UNSET_TILE_HANDLE);
+        canvas_col_x = std::move(col_x);
+        canvas_row_y = std::move(row_y);
+        mark_all_dirty();
+        LOG_TRACE(std::format("Rebuilding {}x{} canvas.", canvas.width(), canvas.height()));
+    }
+
+    // Cells to redraw in row major order, so each band of rows is one contiguous range.
+    std::vector<uint32_t> redraw_cells;
+    for (size_t word = 0; word < dirty_words.size(); word++)
+    {
+        uint64_t bits = dirty_words[word];
+        dirty_words[word] = 0;
+        while (bits)
+        {
+            size_t cell = word * 64 + static_cast<size_t>(std::countr_zero(bits));
+            bits &= bits - 1;
+            if (cell < tile_grid.size() && canvas_grid[cell] != tile_grid[cell])
+                redraw_cells.push_back(static_cast<uint32_t>(cell));
+        }
+    }
+
+    uchar *const bits = canvas.bits();
+    qsizetype const bytes_per_line = canvas.bytesPerLine();
+    size_t band_count = 1;
+    if (redraw_cells.size() >= MAP_RENDER_PARALLEL_MIN_CELLS)
+        band_count = std::min<size_t>(rows, D_Thread_Pool::shared().size() * MAP_RENDER_BANDS_PER_WORKER);
+
+    //! NOTE: Bands cover whole map rows, so no two bands write the same canvas scanline or canvas_grid entry.
+    auto draw_band = [&](size_t band, [[maybe_unused]] size_t worker_idx)
+    {
+        uint32_t first_cell = static_cast<uint32_t>(rows * band / band_count * cols);
+        uint32_t end_cell = static_cast<uint32_t>(rows * (band + 1) / band_count * cols);
+        auto begin = std::lower_bound(redraw_cells.begin(), redraw_cells.end(), first_cell);
+        auto end = std::lower_bound(begin, redraw_cells.end(), end_cell);
+        for (auto cell = begin; cell != end; cell++)
+        {
+            size_t col = *cell % cols;
+            size_t row = *cell / cols;
+            draw_cell(tile_grid[*cell],
+                      0,
+                      0,
+                      0,
+                      bits + canvas_row_y[row] * bytes_per_line + canvas_col_x[col] * static_cast<qsizetype>(sizeof(QRgb)),
+                      canvas_col_x[col + 1] - canvas_col_x[col],
+                      canvas_row_y[row + 1] - canvas_row_y[row],
+                      bytes_per_line);
+            canvas_grid[*cell] = tile_grid[*cell];
+        }
+    };
+    if (band_count > 1)
+        D_Thread_Pool::shared().run(band_count, draw_band);
+    else
+        draw_band(0, 0);
+
+    LOG_TRACE(std::format("Rendered map, {} of {} cells redrawn in {} bands.",
+                          redraw_cells.size(),
+                          tile_grid.size(),
+                          band_count));
+    return canvas;
+}
+
+/***********************************************************************************************************************
+ * @brief Composites a reduced size preview of the current map design from each tile's downsampled image, eg for
+ * thumbnails in a map picker. At TILE_PREVIEW_LEVEL and beyond no full size tile image is touched, tiles loaded with
+ * Image_Load_Mode::Preview are never fully decoded, and only 1/4^level of the pixels are drawn. The persistent canvas is
+ * neither used nor updated. @see D_Tile::get_image_level()
+ *
+ * @param[in] level Level of the tile images to draw, ie the preview is 1/2^level of the full size. Levels below
+ * TILE_PREVIEW_LEVEL need each tile's full image.
+ *
+ * @retval QImage The preview in TILE_IMAGE_FORMAT.
+ **********************************************************************************************************************/
+QImage D_Map::render_preview(size_t level) const
+{
+    std::vector<int> col_x;
+    std::vector<int> row_y;
+    measure_pixel_layout(col_x, row_y, level);
+    return compose_rect(level, col_x, row_y, 0, 0, col_x.back(), row_y.back());
+}
+
+/***********************************************************************************************************************
+ * @brief Saves the current map design as an image to the given file name (and path), the encoder is picked from the
+ * name's extension, ie .png, .ppm or .qoi, anything else is saved as a JPEG. Each encoder uses its default setting.
+ * @see save(file_name, encoder, setting)
+ *
+ * @param[in] file_name File name to use when saving the map.
+ *
+ * @retval bool Wether or not the save was succesful.
+ **********************************************************************************************************************/
+bool D_Map::save(std::string file_name)
+{
+    Image_Encoder encoder = Image_Encoder::Jpeg;
+    if (file_name.ends_with(".png"))
+        encoder = Image_Encoder::Png;
+    else if (file_name.ends_with(".ppm"))
+        encoder = Image_Encoder::Ppm;
+    else if (file_name.ends_with(".qoi"))
+        encoder = Image_Encoder::Qoi;
+
+    return save(file_name, encoder);
+}
+
+/***********************************************************************************************************************
+ * @brief Saves the current map design as an image to the given file name (and path) with the given encoder, the design
+ * is rendered first. The file name's extension is not checked against the encoder. @see render()
  *
  * @param[in] file_name File name to use when saving the map.
+ * @param[in] encoder Encoder to write the image with.
+ * @param[in] setting JPEG quality (0 to 100) or PNG compression level (0 to 9), ignored by the other encoders. Negative
+ * uses DEFAULT_OUTPUT_QUALITY or DEFAULT_PNG_COMPRESSION.
  *
  * @retval bool Wether or not the save was succesful.
+ *
+ * @throws std::invalid_argument If the setting is out of range for the encoder.
  **********************************************************************************************************************/
-bool D_Map::save(std::string file_name) const
+bool D_Map::save(std::string file_name, Image_Encoder encoder, int setting)
 {
-    size_t out_height = 0;
-    size_t out_width = 0;
+    setting = resolve_encoder_setting(encoder, setting);
+    return write_image(render(), file_name, encoder, setting);
+}
 
-    for (const auto &tile : display_mat.at(0))
-        out_height += tile->get_image()->height();
+/***********************************************************************************************************************
+ * @brief Checks an encoder setting and replaces a negative one with the encoder's default.
+ *
+ * @param[in] encoder Encoder the setting is for.
+ * @param[in] setting JPEG quality (0 to 100) or PNG compression level (0 to 9), ignored by the other encoders.
+ *
+ * @retval int The setting to encode with.
+ *
+ * @throws std::invalid_argument If the setting is out of range for the encoder or the encoder is unknown.
+ **********************************************************************************************************************/
+int D_Map::resolve_encoder_setting(Image_Encoder encoder, int setting)
+{
+    switch (encoder)
+    {
+    case Image_Encoder::Jpeg:
+    case Image_Encoder::Png:
+    {
+        bool const is_png = Image_Encoder::Png == encoder;
+        int const max_setting = is_png ? 9 : 100;
+        if (setting < 0)
+            return is_png ? DEFAULT_PNG_COMPRESSION : DEFAULT_OUTPUT_QUALITY;
+        if (setting > max_setting)
+        {
+            throw std::invalid_argument(ERR_FORMAT(std::format("{} setting {} is above {}!",
+                                                               is_png ? "PNG" : "JPEG",
+                                                               setting,
+                                                               max_setting)));
+        }
+        return setting;
+    }
+    case Image_Encoder::Ppm:
+    case Image_Encoder::Qoi:
+        return setting;
+    }
 
-    for (const auto &col : display_mat)
-        out_width += col.at(0)->get_image()->width();
+    throw std::invalid_argument(ERR_FORMAT(std::format("Unknown image encoder {}!", static_cast<int>(encoder))));
+}
 
-    QImage result(static_cast<int>(out_width), static_cast<int>(out_height), QImage::Format_ARGB32);
-    result.fill(Qt::transparent);
-    QPainter painter(&result);
-    size_t current_y = 0;
+/***********************************************************************************************************************
+ * @brief Writes an image in TILE_IMAGE_FORMAT to a file with the given encoder. PPM is converted to RGB in bands of rows
+ * across the shared thread pool and written out at once, so unlike the JPEG encoder its cost scales with the available
+ * cores.
+ *
+ * @param[in] image Image to write.
+ * @param[in] file_name File name (and path) to write to.
+ * @param[in] encoder Encoder to write the image with.
+ * @param[in] setting Setting returned by resolve_encoder_setting().
+ *
+ * @retval bool Wether or not the write was succesful.
+ *
+ * @note PPM has no alpha, transparent pixels are written with their color.
+ **********************************************************************************************************************/
+bool D_Map::write_image(QImage const &image, std::string const &file_name, Image_Encoder encoder, int setting)
+{
+    std::vector<char> out;
+    switch (encoder)
+    {
+    case Image_Encoder::Jpeg:
+    case Image_Encoder::Png:
+    {
+        QImageWriter writer(QString::fromStdString(file_name), Image_Encoder::Png == encoder ? "PNG" : "JPG");
+        if (Image_Encoder::Png == encoder)
+            writer.setCompression(setting);
+        else
+            writer.setQuality(setting);
+        return writer.write(image);
+    }
+    case Image_Encoder::Ppm:
+    {
+        std::string header = std::format("P6\n{} {}\n255\n", image.width(), image.height());
+        out.resize(header.size() + static_cast<size_t>(image.width()) * static_cast<size_t>(image.height()) * 3);
+        std::copy(header.begin(), header.end(), out.begin());
+        convert_to_rgb(image, out.data() + header.size());
+        break;
+    }
+    case Image_Encoder::Qoi:
+        encode_qoi(image, out);
+        break;
+    }
 
-    for (size_t row = 0; row < static_cast<size_t>(rows); row++)
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return static_cast<bool>(file);
+}
+
+/***********************************************************************************************************************
+ * @brief Encodes an image in TILE_IMAGE_FORMAT as a QOI (Quite OK Image) file, 4 channel sRGB. Each pixel becomes a run,
+ * a reference to a recently seen pixel, a small difference from the previous pixel or the pixel itself, so the flat
+ * areas and repeated tiles of a map compress well in a single pass.
+ *
+ * @param[in] image Image to encode.
+ * @param[out] out Buffer the whole file is written to, replacing its contents.
+ *
+ * @note The encoding is inherently sequential, each op depends on every pixel before it.
+ **********************************************************************************************************************/
+void D_Map::encode_qoi(QImage const &image, std::vector<char> &out)
+{
+    uint32_t const width = static_cast<uint32_t>(image.width());
+    uint32_t const height = static_cast<uint32_t>(image.height());
+
+    out.clear();
+    //! NOTE: Worst case is a 5 byte op per pixel plus the 14 byte header and 8 byte end marker.
+    out.reserve(static_cast<size_t>(width) * height * 5 + 22);
+    auto push_u32 = [&out](uint32_t value)
     {
-        size_t current_x = 0;
-        size_t row_height = 0;
-        for (size_t col = 0; col < static_cast<size_t>(cols); col++)
+        for (int shift = 24; shift >= 0; shift -= 8)
+            out.push_back(static_cast<char>(value >> shift));
+    };
+    out.insert(out.end(), {'q', 'o', 'i', 'f'});
+    push_u32(width);
+    push_u32(height);
+    out.push_back(4); // RGBA
+    out.push_back(0); // sRGB with linear alpha
+
+    std::array<QRgb, MAP_QOI_INDEX_SIZE> seen = {};
+    QRgb previous = qRgba(0, 0, 0, 255);
+    size_t run = 0;
+    for (uint32_t y = 0; y < height; y++)
+    {
+        QRgb const *line = reinterpret_cast<QRgb const *>(image.constScanLine(static_cast<int>(y)));
+        for (uint32_t x = 0; x < width; x++)
+        {
+            QRgb const pixel = line[x];
+            if (pixel == previous)
+            {
+                if (++run == MAP_QOI_MAX_RUN)
+                {
+                    out.push_back(static_cast<char>(0xC0 | (run - 1)));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run)
+            {
+                out.push_back(static_cast<char>(0xC0 | (run - 1)));
+                run = 0;
+            }
+
+            size_t const hash = (static_cast<size_t>(qRed(pixel)) * 3 + static_cast<size_t>(qGreen(pixel)) * 5 +
+                                 static_cast<size_t>(qBlue(pixel)) * 7 + static_cast<size_t>(qAlpha(pixel)) * 11) %
+                                MAP_QOI_INDEX_SIZE;
+            if (seen[hash] == pixel)
+            {
+                out.push_back(static_cast<char>(hash));
+            }
+            else if (qAlpha(pixel) != qAlpha(previous))
+            {
+                out.insert(out.end(), {static_cast<char>(0xFF),
+                                       static_cast<char>(qRed(pixel)),
+                                       static_cast<char>(qGreen(pixel)),
+                                       static_cast<char>(qBlue(pixel)),
+                                       static_cast<char>(qAlpha(pixel))});
+            }
+            else
+            {
+                // Channel differences wrap, ie 0 - 255 is 1.
+                int const red = static_cast<int8_t>(qRed(pixel) - qRed(previous));
+                int const green = static_cast<int8_t>(qGreen(pixel) - qGreen(previous));
+                int const blue = static_cast<int8_t>(qBlue(pixel) - qBlue(previous));
+                int const red_green = red - green;
+                int const blue_green = blue - green;
+                if (red >= -2 && red <= 1 && green >= -2 && green <= 1 && blue >= -2 && blue <= 1)
+                {
+                    out.push_back(static_cast<char>(0x40 | ((red + 2) << 4) | ((green + 2) << 2) | (blue + 2)));
+                }
+                else if (green >= -32 && green <= 31 && red_green >= -8 && red_green <= 7 && blue_green >= -8 &&
+                         blue_green <= 7)
+                {
+                    out.push_back(static_cast<char>(0x80 | (green + 32)));
+                    out.push_back(static_cast<char>(((red_green + 8) << 4) | (blue_green + 8)));
+                }
+                else
+                {
+                    out.insert(out.end(), {static_cast<char>(0xFE),
+                                           static_cast<char>(qRed(pixel)),
+                                           static_cast<char>(qGreen(pixel)),
+                                           static_cast<char>(qBlue(pixel))});
+                }
+            }
+            seen[hash] = pixel;
+            previous = pixel;
+        }
+    }
+    if (run)
+        out.push_back(static_cast<char>(0xC0 | (run - 1)));
+
+    out.insert(out.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+}
+
+/***********************************************************************************************************************
+ * @brief Composites the map design one row of tiles at a time into a reused strip image and hands each strip to a sink,
+ * so peak memory is bounded by one strip whatever the map's size. Tiles within a strip are drawn in bands of columns
+ * across the shared thread pool. The persistent canvas is neither used nor updated. @see render()
+ *
+ * @param[in] sink Called with each strip, its full width and the height of its row of tiles, and the pixel y of its
+ * first scanline. The strip is overwritten once the sink returns.
+ **********************************************************************************************************************/
+void D_Map::render_strips(std::function<void(QImage const &strip, int strip_y)> const &sink)
+{
+    std::vector<int> col_x;
+    std::vector<int> row_y;
+    measure_pixel_layout(col_x, row_y);
+
+    size_t band_count = 1;
+    if (cols >= MAP_RENDER_PARALLEL_MIN_CELLS)
+        band_count = std::min<size_t>(cols, D_Thread_Pool::shared().size() * MAP_RENDER_BANDS_PER_WORKER);
+
+    QImage strip;
+    for (uint16_t row = 0; row < rows; row++)
+    {
+        int const strip_height = row_y[row + 1] - row_y[row];
+        if (strip.width() != col_x.back() || strip.height() != strip_height)
+            strip = QImage(col_x.back(), strip_height, TILE_IMAGE_FORMAT);
+
+        uchar *const bits = strip.bits();
+        qsizetype const bytes_per_line = strip.bytesPerLine();
+        //! NOTE: Bands cover whole columns, so no two bands write the same pixels.
+        auto draw_band = [&](size_t band, [[maybe_unused]] size_t worker_idx)
+        {
+            for (size_t col = cols * band / band_count; col < cols * (band + 1) / band_count; col++)
+            {
+                draw_cell(tile_grid[static_cast<size_t>(row) * cols + col],
+                          0,
+                          0,
+                          0,
+                          bits + col_x[col] * static_cast<qsizetype>(sizeof(QRgb)),
+                          col_x[col + 1] - col_x[col],
+                          strip_height,
+                          bytes_per_line);
+            }
+        };
+        if (band_count > 1)
+            D_Thread_Pool::shared().run(band_count, draw_band);
+        else
+            draw_band(0, 0);
+
+        sink(strip, row_y[row]);
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Saves the current map design as a binary PPM (P6) without building the whole image, each strip from
+ * render_strips() is converted and appended to the file as it is composited. Gives the same file as save() with a .ppm
+ * name while keeping memory bounded by one row of tiles, ie for maps too large to hold as one image.
+ *
+ * @param[in] file_name File name to use when saving the map.
+ *
+ * @retval bool Wether or not the save was succesful.
+ **********************************************************************************************************************/
+bool D_Map::save_streamed(std::string file_name)
+{
+    std::vector<int> col_x;
+    std::vector<int> row_y;
+    measure_pixel_layout(col_x, row_y);
+
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    file << std::format("P6\n{} {}\n255\n", col_x.back(), row_y.back());
+
+    std::vector<char> rgb_strip;
+    render_strips([&](QImage const &strip, [[maybe_unused]] int strip_y)
+                  {
+                      rgb_strip.resize(static_cast<size_t>(strip.width()) * static_cast<size_t>(strip.height()) * 3);
+                      convert_to_rgb(strip, rgb_strip.data());
+                      file.write(rgb_strip.data(), static_cast<std::streamsize>(rgb_strip.size())); });
+
+    LOG_DEBUG(std::format("Streamed {}x{} map to {}.", cols, rows, file_name));
+    return static_cast<bool>(file);
+}
+
+/***********************************************************************************************************************
+ * @brief Saves the current map design as a Deep Zoom (DZI) tile pyramid, ie a .dzi descriptor plus a "<name>_files"
+ * directory holding one directory per zoom level of MAP_PYRAMID_TILE_SIZE square tiles, for zoomable viewers. Each
+ * level is composited straight from the tile images downsampled to that level's scale, every output tile only drawing
+ * the cells under it, so no level needs the full resolution design. Levels smaller than one pixel per tile are box
+ * filtered from the smallest tile level instead. Output tiles of a level are composited and encoded across the shared
+ * thread pool.
+ *
+ * @param[in] file_name File name of the .dzi descriptor, the level directories are written beside it.
+ * @param[in] encoder Encoder of the output tiles, Jpeg or Png.
+ * @param[in] setting JPEG quality or PNG compression level, negative uses the default. @see save(file_name, encoder)
+ *
+ * @retval bool Wether or not every file was written.
+ *
+ * @throws std::invalid_argument If the encoder is not Jpeg or Png, or the setting is out of range.
+ *
+ * @note Tiles are expected to share a size. A level is cropped to the full size halved (rounded up) once per level, as
+ * Deep Zoom viewers expect, which only drops pixels when the tile size is not a multiple of the level's scale.
+ **********************************************************************************************************************/
+bool D_Map::save_pyramid(std::string file_name, Image_Encoder encoder, int setting)
+{
+    if (Image_Encoder::Jpeg != encoder && Image_Encoder::Png != encoder)
+        throw std::invalid_argument(ERR_FORMAT("Deep Zoom pyramids can only hold JPEG or PNG tiles!"));
+    setting = resolve_encoder_setting(encoder, setting);
+    char const *extension = Image_Encoder::Png == encoder ? "png" : "jpg";
+
+    std::vector<int> col_x;
+    std::vector<int> row_y;
+    measure_pixel_layout(col_x, row_y);
+    int const full_width = col_x.back();
+    int const full_height = row_y.back();
+    size_t const max_level = static_cast<size_t>(std::bit_width(static_cast<unsigned>(std::max({full_width, full_height, 1}) - 1)));
+    size_t const tile_levels = get_tile(0, 0)->get_level_count();
+
+    std::filesystem::path dzi_path(file_name);
+    std::filesystem::path files_path = dzi_path.parent_path() / (dzi_path.stem().string() + "_files");
+    std::ofstream dzi(dzi_path, std::ios::trunc);
+    dzi << std::format("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                       "<Image xmlns=\"http://schemas.microsoft.com/deepzoom/2008\" Format=\"{}\" Overlap=\"0\" "
+                       "TileSize=\"{}\">\n"
+                       "    <Size Width=\"{}\" Height=\"{}\"/>\n"
+                       "</Image>\n",
+                       extension,
+                       MAP_PYRAMID_TILE_SIZE,
+                       full_width,
+                       full_height);
+    bool saved = static_cast<bool>(dzi);
+
+    QImage small_level; // Whole design at the smallest tile level or below, only used past the tile levels.
+    std::atomic<bool> written = true;
+    for (size_t scale = 0; scale <= max_level; scale++)
+    {
+        size_t const level = max_level - scale;
+        std::filesystem::path level_path = files_path / std::to_string(level);
+        std::filesystem::create_directories(level_path);
+
+        int level_width = full_width;
+        int level_height = full_height;
+        for (size_t halving = 0; halving < scale; halving++)
+        {
+            level_width = (level_width + 1) / 2;
+            level_height = (level_height + 1) / 2;
+        }
+
+        if (scale < tile_levels)
+        {
+            measure_pixel_layout(col_x, row_y, scale);
+            if (scale + 1 == tile_levels)
+                small_level = compose_rect(scale, col_x, row_y, 0, 0, col_x.back(), row_y.back());
+        }
+        else
+        {
+            small_level = D_Tile::downsample(small_level);
+        }
+
+        int const tiles_across = (level_width + MAP_PYRAMID_TILE_SIZE - 1) / MAP_PYRAMID_TILE_SIZE;
+        int const tiles_down = (level_height + MAP_PYRAMID_TILE_SIZE - 1) / MAP_PYRAMID_TILE_SIZE;
+        D_Thread_Pool::shared().run(static_cast<size_t>(tiles_across) * static_cast<size_t>(tiles_down),
+                                    [&](size_t job_idx, [[maybe_unused]] size_t worker_idx)
+                                    {
+                                        int const tile_col = static_cast<int>(job_idx % static_cast<size_t>(tiles_across));
+                                        int const tile_row = static_cast<int>(job_idx / static_cast<size_t>(tiles_across));
+                                        int const x = tile_col * MAP_PYRAMID_TILE_SIZE;
+                                        int const y = tile_row * MAP_PYRAMID_TILE_SIZE;
+                                        int const width = std::min(MAP_PYRAMID_TILE_SIZE, level_width - x);
+                                        int const height = std::min(MAP_PYRAMID_TILE_SIZE, level_height - y);
+                                        QImage tile_image = scale + 1 < tile_levels
+                                                                ? compose_rect(scale, col_x, row_y, x, y, width, height)
+                                                                : small_level.copy(x, y, width, height);
+                                        std::string tile_name = (level_path / std::format("{}_{}.{}", tile_col, tile_row, extension)).string();
+                                        if (!write_image(tile_image, tile_name, encoder, setting))
+                                            written = false;
+                                    });
+    }
+
+    LOG_DEBUG(std::format("Saved {} level pyramid of {}x{} map to {}.", max_level + 1, cols, rows, file_name));
+    return saved && written;
+}
+
+/***********************************************************************************************************************
+ * @brief Measures the pixel position of every column and row of tiles.
+ *
+ * @param[out] col_x Pixel x of each column's left edge, plus the total width.
+ * @param[out] row_y Pixel y of each row's top edge, plus the total height.
+ * @param[in] level Level of the tile images measured, 0 is full size. @see D_Tile::get_image_level()
+ *
+ * @note Column widths and row heights come from the first row's and column's tiles, tiles are expected to share a size.
+ **********************************************************************************************************************/
+void D_Map::measure_pixel_layout(std::vector<int> &col_x, std::vector<int> &row_y, size_t level) const
+{
+    col_x.assign(static_cast<size_t>(cols) + 1, 0);
+    row_y.assign(static_cast<size_t>(rows) + 1, 0);
+    for (uint16_t col = 0; col < cols; col++)
+        col_x[col + 1] = col_x[col] + get_tile(col, 0)->get_image_level(level).width();
+    for (uint16_t row = 0; row < rows; row++)
+        row_y[row + 1] = row_y[row] + get_tile(0, row)->get_image_level(level).height();
+}
+
+/***********************************************************************************************************************
+ * @brief Composites one rectangle of the map design from the tile images at a level, only the cells overlapping the
+ * rectangle are drawn so the cost and memory follow the rectangle's size rather than the map's.
+ *
+ * @param[in] level Level of the tile images to draw from, 0 is full size.
+ * @param[in] col_x Pixel x of each column at that level. @see measure_pixel_layout()
+ * @param[in] row_y Pixel y of each row at that level.
+ * @param[in] x Pixel x of the rectangle's left edge.
+ * @param[in] y Pixel y of the rectangle's top edge.
+ * @param[in] width Width of the rectangle, must lie within col_x.
+ * @param[in] height Height of the rectangle, must lie within row_y.
+ *
+ * @retval QImage The rectangle in TILE_IMAGE_FORMAT.
+ **********************************************************************************************************************/
+QImage D_Map::compose_rect(size_t level,
+                           std::vector<int> const &col_x,
+                           std::vector<int> const &row_y,
+                           int x,
+                           int y,
+                           int width,
+                           int height) const
+{
+    QImage out(width, height, TILE_IMAGE_FORMAT);
+    uchar *const bits = out.bits();
+    qsizetype const bytes_per_line = out.bytesPerLine();
+
+    // Columns and rows whose span overlaps the rectangle.
+    size_t const first_col = static_cast<size_t>(std::upper_bound(col_x.begin(), col_x.end(), x) - col_x.begin()) - 1;
+    size_t const first_row = static_cast<size_t>(std::upper_bound(row_y.begin(), row_y.end(), y) - row_y.begin()) - 1;
+    for (size_t row = first_row; row < rows && row_y[row] < y + height; row++)
+    {
+        int const top = std::max(row_y[row], y);
+        int const bottom = std::min(row_y[row + 1], y + height);
+        for (size_t col = first_col; col < cols && col_x[col] < x + width; col++)
         {
-            std::shared_ptr<QImage> image = display_mat.at(col).at(row)->get_image();
-            painter.drawImage(static_cast<int>(current_x),
-                              static_cast<int>(current_y),
-                              *image);
-            current_x += image->width();
-            row_height = std::max(row_height, static_cast<size_t>(image->height()));
+            int const left = std::max(col_x[col], x);
+            int const right = std::min(col_x[col + 1], x + width);
+            draw_cell(tile_grid[row * cols + col],
+                      level,
+                      left - col_x[col],
+                      top - row_y[row],
+                      bits + (top - y) * bytes_per_line + (left - x) * static_cast<qsizetype>(sizeof(QRgb)),
+                      right - left,
+                      bottom - top,
+                      bytes_per_line);
         }
-        current_y += row_height;
     }
-    painter.end();
+    return out;
+}
 
-    return result.save(QString::fromStdString(file_name), "JPG", DEFAULT_OUTPUT_QUALITY);
+/***********************************************************************************************************************
+ * @brief Converts an image in TILE_IMAGE_FORMAT to packed 8 bit RGB, in bands of rows across the shared thread pool.
+ *
+ * @param[in] image Image to convert.
+ * @param[out] out Buffer of at least width * height * 3 bytes.
+ *
+ * @note Alpha is dropped, transparent pixels keep their color.
+ **********************************************************************************************************************/
+void D_Map::convert_to_rgb(QImage const &image, char *out)
+{
+    size_t const width = static_cast<size_t>(image.width());
+    size_t const height = static_cast<size_t>(image.height());
+    size_t band_count = std::clamp<size_t>(height, 1, D_Thread_Pool::shared().size() * MAP_RENDER_BANDS_PER_WORKER);
+    D_Thread_Pool::shared().run(band_count, [&](size_t band, [[maybe_unused]] size_t worker_idx)
+                                {
+                                    for (size_t y = height * band / band_count; y < height * (band + 1) / band_count; y++)
+                                    {
+                                        QRgb const *line = reinterpret_cast<QRgb const *>(image.constScanLine(static_cast<int>(y)));
+                                        char *rgb = out + y * width * 3;
+                                        for (size_t x = 0; x < width; x++)
+                                        {
+                                            *rgb++ = static_cast<char>(qRed(line[x]));
+                                            *rgb++ = static_cast<char>(qGreen(line[x]));
+                                            *rgb++ = static_cast<char>(qBlue(line[x]));
+                                        }
+                                    } });
 }
 
 /***********************************************************************************************************************
@@ -198,10 +1218,85 @@ bool D_Map::save(std::string file_name) const
  *
  * @param[in] col X coordinate in the map.
  * @param[in] row Y coordinate in the map.
+ * @param[in] replacement Tile to place, must be the Empty_Tile or a tile in the map's usable tiles.
+ *
+ * @throws std::out_of_range if the point is outside of the map or the tile is not usable by the map.
  **********************************************************************************************************************/
-void D_Map::swap_tile(uint8_t col, uint8_t row, std::shared_ptr<D_Tile> replacement)
+void D_Map::swap_tile(uint16_t col, uint16_t row, std::shared_ptr<D_Tile> const &replacement)
 {
-    display_mat.at(col).at(row) = replacement;
+    if (col >= cols || row >= rows)
+        throw std::out_of_range(ERR_FORMAT("Tried to swap a tile outside of the map!"));
+
+    mark_dirty(col, row);
+    if (!replacement)
+        set_cell(col, row, MAP_UNSET_TILE_HANDLE);
+    else if (replacement == Empty_Tile)
+        set_cell(col, row, MAP_EMPTY_TILE_HANDLE);
+    else
+        set_cell(col, row, static_cast<uint16_t>(tile_index->find_slot(replacement->get_id())));
+}
+
+/***********************************************************************************************************************
+ * @brief Regenerates the tiles within a rectangle of the map, every tile outside of it is kept. The rectangle is solved
+ * like the Propagate mode with the facing sides of the tiles around it as fixed constraints, so the new tiles always
+ * meet them. No entrance is placed, cells the surrounding tiles do not connect into may end up empty. Only the
+ * rectangle is reset and solved, so the cost scales with its area rather than the map's.
+ *
+ * @param[in] col0 Left column of the rectangle.
+ * @param[in] row0 Top row of the rectangle.
+ * @param[in] col1 Right column of the rectangle, inclusive.
+ * @param[in] row1 Bottom row of the rectangle, inclusive.
+ *
+ * @throws std::out_of_range if the rectangle is empty or not within the map.
+ * @throws std::runtime_error if the tile set cannot meet the surrounding tiles, the map is left unchanged.
+ *
+ * @note Used in either generation mode. The random sequence continues from the last generation, so get_seed() alone no
+ * longer reproduces the design once a region has been regenerated.
+ **********************************************************************************************************************/
+void D_Map::regenerate_region(uint16_t col0, uint16_t row0, uint16_t col1, uint16_t row1)
+{
+    if (col0 > col1 || row0 > row1 || col1 >= cols || row1 >= rows)
+        throw std::out_of_range(ERR_FORMAT(std::format("Tried to regenerate region ({}, {})-({}, {}) of a {}x{} map!",
+                                                       col0, row0, col1, row1, cols, rows)));
+
+    solver.window_col = col0;
+    solver.window_row = row0;
+    solver.window_cols = static_cast<uint16_t>(col1 - col0 + 1);
+    solver.window_rows = static_cast<uint16_t>(row1 - row0 + 1);
+    size_t const cell_count = static_cast<size_t>(solver.window_cols) * solver.window_rows;
+
+    // Kept so a failed solve leaves the map as it was.
+    std::vector<uint16_t> previous(cell_count);
+    for (uint16_t row = 0; row < solver.window_rows; row++)
+    {
+        auto row_start = tile_grid.begin() + static_cast<ptrdiff_t>(grid_cell(static_cast<uint32_t>(row) * solver.window_cols));
+        std::copy(row_start, row_start + solver.window_cols, previous.begin() + static_cast<ptrdiff_t>(row) * solver.window_cols);
+    }
+
+    try
+    {
+        solve_constraints(false);
+    }
+    catch (std::runtime_error const &)
+    {
+        for (uint16_t row = 0; row < solver.window_rows; row++)
+        {
+            auto prev_start = previous.begin() + static_cast<ptrdiff_t>(row) * solver.window_cols;
+            std::copy(prev_start, prev_start + solver.window_cols,
+                      tile_grid.begin() + static_cast<ptrdiff_t>(grid_cell(static_cast<uint32_t>(row) * solver.window_cols)));
+        }
+        throw;
+    }
+
+    for (uint32_t cell = 0; cell < cell_count; cell++)
+    {
+        uint16_t &handle = tile_grid[grid_cell(cell)];
+        if (MAP_UNSET_TILE_HANDLE == handle)
+            handle = MAP_EMPTY_TILE_HANDLE;
+        mark_dirty(static_cast<uint16_t>(col0 + cell % solver.window_cols),
+                   static_cast<uint16_t>(row0 + cell / solver.window_cols));
+    }
+    LOG_DEBUG(std::format("Regenerated region ({}, {})-({}, {}) of a {}x{} map.", col0, row0, col1, row1, cols, rows));
 }
 
 /***********************************************************************************************************************
@@ -209,73 +1304,248 @@ void D_Map::swap_tile(uint8_t col, uint8_t row, std::shared_ptr<D_Tile> replacem
  *
  * @retval std::string The map in a stringified form.
  **********************************************************************************************************************/
-std::string const D_Map::to_string() const
+std::string const D_Map::to_string() const
+{
+    std::stringstream ss;
+    ss << "\n\n- - - D_Map Info: - - -\n";
+    ss << "\tTheme: " << theme << "\n";
+    ss << "\tColumns: " << static_cast<int>(cols) << "\n";
+    ss << "\tRows: " << static_cast<int>(rows) << "\n";
+    ss << "\tConnection Chance: " << static_cast<int>(connection_chance) << "\n";
+    ss << "\tSeed: " << seed << "\n";
+    ss << "- - - Connections - - -\n";
+
+    for (size_t row = 0; row < static_cast<size_t>(rows); row++)
+    {
+        ss << "Row[" << row << "]:";
+        for (size_t col = 0; col < static_cast<size_t>(cols); col++)
+        {
+            D_Tile *tile = get_tile_from_handle(tile_grid[row * cols + col]);
+            if (tile)
+                ss << "[" << tile->connections_to_string() << "]";
+            else
+                ss << "[null]";
+        }
+        ss << "\n";
+    }
+
+    ss << "- - - - - - - - - - - -\n\n";
+    return ss.str();
+}
+
+/***********************************************************************************************************************
+ * @brief Returns the tile at the given point in the map.
+ *
+ * @param[in] col X coordinate in the map.
+ * @param[in] row Y coordinate in the map.
+ *
+ * @retval D_Tile* The tile at that point, nullptr if no tile has been set there. It lives as long as the map's tile
+ * index, hold the tile's std::shared_ptr from Tile_Map to keep it past that.
+ *
+ * @throws std::out_of_range if the point is outside of the map.
+ **********************************************************************************************************************/
+D_Tile *D_Map::get_tile(uint16_t col, uint16_t row) const
+{
+    if (col >= cols || row >= rows)
+        throw std::out_of_range(ERR_FORMAT("Tried to get a tile outside of the map!"));
+
+    return get_tile_from_handle(tile_grid[static_cast<size_t>(row) * cols + col]);
+}
+
+/***********************************************************************************************************************
+ * @brief Resolves a tile handle from the tile grid into its tile.
+ *
+ * @param[in] handle Handle to resolve, @see get_tile_grid().
+ *
+ * @retval D_Tile* The tile the handle refers to, nullptr for MAP_UNSET_TILE_HANDLE.
+ **********************************************************************************************************************/
+D_Tile *D_Map::get_tile_from_handle(uint16_t handle) const
+{
+    if (MAP_UNSET_TILE_HANDLE == handle)
+        return nullptr;
+    if (MAP_EMPTY_TILE_HANDLE == handle)
+        return Empty_Tile.get();
+    return tile_index->get_tile(handle);
+}
+
+/***********************************************************************************************************************
+ * @brief Returns the tile grid of the map, cell (col, row) is held at [row * cols + col].
+ *
+ * @retval std::vector<uint16_t> The row major grid of tile handles, resolve them with get_tile_from_handle().
+ **********************************************************************************************************************/
+std::vector<uint16_t> const &D_Map::get_tile_grid() const
+{
+    return tile_grid;
+}
+
+/***********************************************************************************************************************
+ * @brief Returns the width of the map.
+ *
+ * @retval uint16_t Number of columns in the map.
+ **********************************************************************************************************************/
+uint16_t D_Map::get_cols() const
+{
+    return cols;
+}
+
+/***********************************************************************************************************************
+ * @brief Returns the height of the map.
+ *
+ * @retval uint16_t Number of rows in the map.
+ **********************************************************************************************************************/
+uint16_t D_Map::get_rows() const
+{
+    return rows;
+}
+
+/***********************************************************************************************************************
+ * @brief Returns the connection chance set for the map.
+ *
+ * @retval uint8_t The set connection chance between tiles during generation.
+ **********************************************************************************************************************/
+uint8_t D_Map::get_connection_chance() const
+{
+    return connection_chance;
+}
+
+/***********************************************************************************************************************
+ * @brief Returns the seed of the current design, generating with this seed reproduces the design.
+ *
+ * @retval uint64_t The seed the current design was generated from.
+ **********************************************************************************************************************/
+uint64_t D_Map::get_seed() const
+{
+    return seed;
+}
+
+/***********************************************************************************************************************
+ * @brief Returns the generation mode of the map.
+ *
+ * @retval Generation_Mode How the map generates designs.
+ **********************************************************************************************************************/
+Generation_Mode D_Map::get_generation_mode() const
+{
+    return generation_mode;
+}
+
+/***********************************************************************************************************************
+ * @brief Sets the generation mode used by the next generation, the current design is kept.
+ *
+ * @param[in] mode How the map should generate designs.
+ **********************************************************************************************************************/
+void D_Map::set_generation_mode(Generation_Mode mode)
+{
+    generation_mode = mode;
+}
+
+/*
+========================================================================================================================
+- - Private Functions - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Sets the map's seed and reseeds the random number generator from it.
+ *
+ * @param[in] in_seed Seed to use.
+ *
+ * @note Engine seeding only uses fixed integer algorithms, so a seed gives the same sequence on every platform.
+ **********************************************************************************************************************/
+void D_Map::reseed(uint64_t in_seed)
+{
+    seed = in_seed;
+    seed_engine(gen, in_seed);
+}
+
+/***********************************************************************************************************************
+ * @brief Rolls a uniform random number in [0, bound).
+ *
+ * @param[in] bound Exclusive upper bound, must be non zero.
+ *
+ * @retval uint32_t The rolled number.
+ *
+ * @note std::uniform_int_distribution is implementation defined, bounded_roll() is not, so designs stay reproducible
+ * across standard libraries.
+ **********************************************************************************************************************/
+uint32_t D_Map::roll(uint32_t bound)
+{
+    return bounded_roll(gen, bound);
+}
+
+/***********************************************************************************************************************
+ * @brief Resets the data structures used to generate the map design, should be called before any other generation
+ * processing.
+ **********************************************************************************************************************/
+void D_Map::reset_for_generate()
+{
+    //! NOTE: assign() reuses the grid's storage, so regenerating a map of the same size does not allocate.
+    tile_grid.assign(static_cast<size_t>(cols) * rows, MAP_UNSET_TILE_HANDLE);
+    queued_words.assign((tile_grid.size() + 63) / 64, 0);
+    to_visit.clear();
+}
+
+/***********************************************************************************************************************
+ * @brief Places a point in the to visit queue unless it has already been queued during this generation.
+ *
+ * @param[in] col X coordinate in the map.
+ * @param[in] row Y coordinate in the map.
+ *
+ * @retval bool True if the point was queued, false if it had already been queued.
+ *
+ * @warning The point is not bounds checked.
+ **********************************************************************************************************************/
+bool D_Map::queue_visit(uint16_t col, uint16_t row)
 {
-    std::stringstream ss;
-    ss << "\n\n- - - D_Map Info: - - -\n";
-    ss << "\tTheme: " << theme << "\n";
-    ss << "\tColumns: " << static_cast<int>(cols) << "\n";
-    ss << "\tRows: " << static_cast<int>(rows) << "\n";
-    ss << "\tConnection Chance: " << static_cast<int>(connection_chance) << "\n";
-    ss << "- - - Connections - - -\n";
-
-    for (size_t row = 0; row < static_cast<size_t>(rows); row++)
-    {
-        ss << "Row[" << row << "]:";
-        for (size_t col = 0; col < static_cast<size_t>(cols); col++)
-        {
-            std::shared_ptr<D_Tile> tile = display_mat.at(col).at(row);
-            if (tile)
-                ss << "[" << tile->connections_to_string() << "]";
-            else
-                ss << "[null]";
-        }
-        ss << "\n";
-    }
+    size_t cell = static_cast<size_t>(row) * cols + col;
+    uint64_t cell_bit = 1ULL << (cell % 64);
+    if (queued_words[cell / 64] & cell_bit)
+        return false;
 
-    ss << "- - - - - - - - - - - -\n\n";
-    return ss.str();
+    queued_words[cell / 64] |= cell_bit;
+    to_visit.push_back({col, row});
+    return true;
 }
 
 /***********************************************************************************************************************
- * @brief Returns the display matrix of a map.
+ * @brief Sets the tile handle at the given point in the tile grid.
+ *
+ * @param[in] col X coordinate in the map.
+ * @param[in] row Y coordinate in the map.
+ * @param[in] handle Tile handle to place.
  *
- * @retval std::vector<std::vector<std::shared_ptr<D_Tile>>> A 2D vector of the map in [col][row] form.
+ * @warning The point is not bounds checked.
  **********************************************************************************************************************/
-std::vector<std::vector<std::shared_ptr<D_Tile>>> const &D_Map::get_display_mat()
+void D_Map::set_cell(uint16_t col, uint16_t row, uint16_t handle)
 {
-    return display_mat;
+    tile_grid[static_cast<size_t>(row) * cols + col] = handle;
 }
 
 /***********************************************************************************************************************
- * @brief Returns the connection chance set for the map.
+ * @brief Gets the connections of the tile a handle refers to.
  *
- * @retval uint8_t The set connection chance between tiles during generation.
+ * @param[in] handle Tile handle from the tile grid.
+ *
+ * @retval D_Connections Connections of the tile, no connections for an unset or empty cell.
  **********************************************************************************************************************/
-uint8_t D_Map::get_connection_chance() const
+D_Connections D_Map::get_cell_connections(uint16_t handle) const
 {
-    return connection_chance;
+    if (MAP_UNSET_TILE_HANDLE == handle || MAP_EMPTY_TILE_HANDLE == handle)
+        return {.mask = CONNECTION_ZERO_MASK};
+    return tile_index->get_connections(handle);
 }
 
-/*
-========================================================================================================================
-- - Private Functions - -
-========================================================================================================================
-*/
-
 /***********************************************************************************************************************
- * @brief Resets the data structures used to generate the map design, should be called before any other generation
- * processing.
+ * @brief Gets the connections of the tile a handle refers to as a neighboor sees them, ie each side bit reversed.
+ *
+ * @param[in] handle Tile handle from the tile grid.
+ *
+ * @retval D_Connections Mirrored connections of the tile, no connections for an unset or empty cell.
  **********************************************************************************************************************/
-void D_Map::reset_for_generate()
+D_Connections D_Map::get_cell_facing_connections(uint16_t handle) const
 {
-    display_mat.clear();
-    to_visit.clear();
-    display_mat.resize(cols);
-    for (size_t col = 0; col < cols; col++)
-    {
-        display_mat.at(col).resize(rows, {nullptr});
-    }
+    if (MAP_UNSET_TILE_HANDLE == handle || MAP_EMPTY_TILE_HANDLE == handle)
+        return {.mask = CONNECTION_ZERO_MASK};
+    return tile_index->get_facing_connections(handle);
 }
 
 /***********************************************************************************************************************
@@ -284,13 +1554,11 @@ void D_Map::reset_for_generate()
  **********************************************************************************************************************/
 void D_Map::start_generation_at_entrance()
 {
-    uint8_t ent_col, ent_row;
+    uint16_t ent_col, ent_row;
     D_Connections possible_connections = {.mask = CONNECTION_FULL_MASK};
 
-    distr.param(std::uniform_int_distribution<unsigned long>::param_type(0, cols - 1));
-    ent_col = static_cast<uint8_t>(distr(gen));
-    distr.param(std::uniform_int_distribution<unsigned long>::param_type(0, rows - 1));
-    ent_row = static_cast<uint8_t>(distr(gen));
+    ent_col = static_cast<uint16_t>(roll(cols));
+    ent_row = static_cast<uint16_t>(roll(rows));
 
     if (0 == ent_col)
     {
@@ -321,19 +1589,14 @@ void D_Map::start_generation_at_entrance()
         }
     }
 
-    // Filter tiles that have connections outside of possible
-    std::vector<std::shared_ptr<D_Tile>> tile_canidates = {};
-    tile_canidates.reserve(Entrance_Map.size());
-    for (auto &&tile_pair : Entrance_Map)
-    {
-        if ((tile_pair.second->get_connections().mask & ~possible_connections.mask) != 0)
-        {
-            continue;
-        }
-        tile_canidates.push_back(tile_pair.second);
-    }
+    // Filter entrance tiles that have connections outside of possible
+    size_t canidate_count = tile_index->filter(D_Tile_Set::Entrances,
+                                               CONNECTION_ZERO_MASK,
+                                               possible_connections.mask,
+                                               {.mask = CONNECTION_ZERO_MASK},
+                                               canidate_words);
 
-    if (tile_canidates.empty())
+    if (!canidate_count)
     {
         std::stringstream err;
         err << "Whilst filtering canidates for an entrance we could not find a tile that met requirements!"
@@ -342,26 +1605,49 @@ void D_Map::start_generation_at_entrance()
         throw std::runtime_error(ERR_FORMAT(err.str()));
     }
 
-    distr.param(std::uniform_int_distribution<unsigned long>::param_type(0, tile_canidates.size() - 1UL));
-    std::shared_ptr<D_Tile> chosen_tile = tile_canidates.at(distr(gen));
-    swap_tile(ent_col, ent_row, chosen_tile);
+    uint16_t chosen_handle = static_cast<uint16_t>(tile_index->nth_canidate(canidate_words,
+                                                                            roll(static_cast<uint32_t>(canidate_count))));
+    set_cell(ent_col, ent_row, chosen_handle);
 
-    D_Connections chosen_connections = chosen_tile->get_connections();
+    D_Connections chosen_connections = get_cell_connections(chosen_handle);
     for (size_t i = 0; i < MAX_NEIGHBOORS; i++)
     {
-        uint8_t n_col = ent_col + static_cast<uint8_t>(TILE_NEIGHBOOR_OFFSETS[i].first);
-        uint8_t n_row = ent_row + static_cast<uint8_t>(TILE_NEIGHBOOR_OFFSETS[i].second);
+        uint16_t n_col = ent_col + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[i].first);
+        uint16_t n_row = ent_row + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[i].second);
         if (n_col >= cols || n_row >= rows) // ie out of map bounds
         {
             continue;
         }
         else if (chosen_connections.sides[i])
         {
-            to_visit.push_back({n_col, n_row});
+            queue_visit(n_col, n_row);
         }
     }
 }
 
+/***********************************************************************************************************************
+ * @brief Sets the connection index used during generation. When generating from the global Tile_Map the shared global
+ * Tile_Index is used, otherwise an index is built once over the given tiles.
+ *
+ * @param[in] usable_tiles Map of tiles to use during generation.
+ *
+ * @throws std::invalid_argument if there are more usable tiles than a tile handle can refer to.
+ **********************************************************************************************************************/
+void D_Map::set_tile_index(std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> &usable_tiles)
+{
+    if (&usable_tiles == &Tile_Map && Tile_Index && Tile_Index->size() == Tile_Map.size())
+        tile_index = Tile_Index;
+    else
+        tile_index = std::make_shared<D_Tile_Index const>(usable_tiles);
+
+    if (tile_index->size() >= MAP_EMPTY_TILE_HANDLE)
+        throw std::invalid_argument(ERR_FORMAT(std::format("D_Map supports at most {} usable tiles, given {}!",
+                                                           MAP_EMPTY_TILE_HANDLE,
+                                                           tile_index->size())));
+
+    canidate_words.assign(tile_index->get_word_count(), 0);
+}
+
 /***********************************************************************************************************************
  * @brief Returns a pointer to a tile that meets the valid connection requirements set and that does not use connections
  * that are not present in the possible connection mask. If possible connections are not present a tile is selected
@@ -370,65 +1656,37 @@ void D_Map::start_generation_at_entrance()
  * @param[in] required_connections Connections that need to be present.
  * @param[in] possible_connections Connections that may be present.
  *
- * @retval std::shared_ptr<D_Tile> A tile which meets the passed connection requirements, ie, all valid connections are
- * met and any set of possible connections may be met.
+ * @retval uint16_t Handle of a tile which meets the passed connection requirements, ie, all valid connections are met
+ * and any set of possible connections may be met.
+ *
+ * @note Canidates are intersected from the tile index rather than scanned, @see D_Tile_Index::filter.
  **********************************************************************************************************************/
-std::shared_ptr<D_Tile> D_Map::chose_tile_based_on_connections(D_Connections required_connections,
-                                                               D_Connections possible_connections = {.mask = CONNECTION_ZERO_MASK},
-                                                               std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> const &tile_map = Tile_Map)
+uint16_t D_Map::chose_tile_based_on_connections(D_Connections required_connections,
+                                                D_Connections possible_connections = {.mask = CONNECTION_ZERO_MASK})
 {
-    std::vector<std::shared_ptr<D_Tile>> tile_canidates = {};
-    tile_canidates.reserve(tile_map.size());
+    size_t canidate_count = 0;
 
     if (possible_connections.mask)
     {
-        for (auto tile_pair : tile_map)
-        {
-            D_Connections tile_connections = tile_pair.second->get_connections();
-
-            // Check required connections
-            if ((tile_connections.mask & required_connections.mask) != required_connections.mask)
-            {
-                continue;
-            }
-
-            // Check for any connection outside of the complete connection mask, ie not in required, or not in possible.
-            uint32_t complete_mask = required_connections.mask | possible_connections.mask;
-            if ((tile_connections.mask & ~complete_mask) != 0)
-            {
-                continue;
-            }
-
-            // Ensure that we have a connection in the valid possible directions
-            bool missing_required_direction = false;
-            for (int i = 0; i < MAX_NEIGHBOORS; ++i)
-            {
-                if (possible_connections.sides[i] && (possible_connections.sides[i] & tile_connections.sides[i]) == 0)
-                {
-                    missing_required_direction = true;
-                    break;
-                }
-            }
-            if (missing_required_direction)
-            {
-                continue;
-            }
-
-            // All condtions for the canidate have been met, add it to the list to choose from
-            tile_canidates.push_back(tile_pair.second);
-        }
+        /*! NOTE: A canidate must have every required connection, no connection outside of the required and possible
+        masks, and at least one connection on each side that has possible connections.*/
+        canidate_count = tile_index->filter(D_Tile_Set::All,
+                                            required_connections.mask,
+                                            required_connections.mask | possible_connections.mask,
+                                            possible_connections,
+                                            canidate_words);
     }
     else
     {
         // Else we only have valid connections and should match on that.
-        for (auto tile_pair : tile_map)
-        {
-            if (required_connections.mask == tile_pair.second->get_connections().mask)
-                tile_canidates.push_back(tile_pair.second);
-        }
+        canidate_count = tile_index->filter(D_Tile_Set::All,
+                                            required_connections.mask,
+                                            required_connections.mask,
+                                            {.mask = CONNECTION_ZERO_MASK},
+                                            canidate_words);
     }
 
-    if (tile_canidates.empty())
+    if (!canidate_count)
     {
         std::stringstream err;
         err << "Whilst filtering canidates we could not find a tile that met requirements!"
@@ -438,8 +1696,7 @@ std::shared_ptr<D_Tile> D_Map::chose_tile_based_on_connections(D_Connections req
         throw std::runtime_error(ERR_FORMAT(err.str()));
     }
 
-    distr.param(std::uniform_int_distribution<unsigned long>::param_type(0, tile_canidates.size() - 1UL));
-    return tile_canidates.at(distr(gen));
+    return static_cast<uint16_t>(tile_index->nth_canidate(canidate_words, roll(static_cast<uint32_t>(canidate_count))));
 }
 
 /***********************************************************************************************************************
@@ -451,15 +1708,14 @@ void D_Map::place_nodes()
 {
     while (!to_visit.empty())
     {
-        std::pair<uint8_t, uint8_t> current = to_visit.front();
-        LOG_DEBUG(std::format("Visiting col:{} row:{}", current.first, current.second));
+        std::pair<uint16_t, uint16_t> current = to_visit.front();
+        LOG_TRACE(std::format("Visiting col:{} row:{}", current.first, current.second));
         to_visit.pop_front();
         D_Connections required_connections = {.mask = CONNECTION_ZERO_MASK};
         D_Connections possible_connections = {.mask = CONNECTION_ZERO_MASK};
         calculate_connections_and_add_visitors(current, required_connections, possible_connections);
-        std::shared_ptr<D_Tile> chosen_tile = chose_tile_based_on_connections(required_connections,
-                                                                              possible_connections);
-        swap_tile(current.first, current.second, chosen_tile);
+        set_cell(current.first, current.second, chose_tile_based_on_connections(required_connections,
+                                                                                possible_connections));
     }
 }
 
@@ -471,31 +1727,30 @@ void D_Map::place_nodes()
  * @param[inout] required_connections Connection mask to fill with connections we need to connect to.
  * @param[inout] connections Connection mask to maybe match connections with.
  **********************************************************************************************************************/
-void D_Map::calculate_connections_and_add_visitors(std::pair<uint8_t, uint8_t> const &current_point,
+void D_Map::calculate_connections_and_add_visitors(std::pair<uint16_t, uint16_t> const &current_point,
                                                    D_Connections &required_connections,
                                                    D_Connections &possible_connections)
 {
-    distr.param(std::uniform_int_distribution<unsigned long>::param_type(0, ONE_HUNDRED_PERCENT));
 
-    uint8_t current_col = current_point.first;
-    uint8_t current_row = current_point.second;
+    uint16_t current_col = current_point.first;
+    uint16_t current_row = current_point.second;
     for (size_t i = 0; i < MAX_NEIGHBOORS; i++)
     {
-        uint8_t n_col = current_col + static_cast<uint8_t>(TILE_NEIGHBOOR_OFFSETS[i].first);
-        uint8_t n_row = current_row + static_cast<uint8_t>(TILE_NEIGHBOOR_OFFSETS[i].second);
+        uint16_t n_col = current_col + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[i].first);
+        uint16_t n_row = current_row + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[i].second);
         if (n_col >= cols || n_row >= rows) // ie out of map bounds
         {
             continue;
         }
 
-        std::shared_ptr<D_Tile> n_tile = display_mat.at(n_col).at(n_row);
-        if (n_tile) // Neighboor already set with connections
+        uint16_t n_handle = tile_grid[static_cast<size_t>(n_row) * cols + n_col];
+        if (MAP_UNSET_TILE_HANDLE != n_handle) // Neighboor already set with connections
         {
-            // Get our neighboors connections and reverse them
+            // Get our neighboors connections as seen from this side, mirrored once when the index was built
             uint8_t n_con_idx = TILE_NEIGHBOOR_SIDE_IDX_MIRRORS[i];
-            required_connections.sides[i] = reverse_8bits(n_tile->get_connections().sides[n_con_idx]);
+            required_connections.sides[i] = get_cell_facing_connections(n_handle).sides[n_con_idx];
         }
-        else if (distr(gen) <= connection_chance) // Give a chance to possibly connect in that direction
+        else if (roll(ONE_HUNDRED_PERCENT + 1) <= connection_chance) // Give a chance to possibly connect in that direction
         {
             possible_connections.sides[i] = CONNECTION_SIDE_MASK_CORNER_EXCLUDE;
         }
@@ -520,19 +1775,19 @@ void D_Map::calculate_connections_and_add_visitors(std::pair<uint8_t, uint8_t> c
             possible_connections.sides[(next & NEXT_SIDE_IDX_BIT_MASK)] |= CONNECTION_SIDE_MASK_CORNER_EXCLUDE;
         }
 
-        uint8_t corner_n_col = current_col + static_cast<uint8_t>(TILE_CORNER_NEIGHBOOR_OFFSETS[i].first);
-        uint8_t corner_n_row = current_row + static_cast<uint8_t>(TILE_CORNER_NEIGHBOOR_OFFSETS[i].second);
+        uint16_t corner_n_col = current_col + static_cast<uint16_t>(TILE_CORNER_NEIGHBOOR_OFFSETS[i].first);
+        uint16_t corner_n_row = current_row + static_cast<uint16_t>(TILE_CORNER_NEIGHBOOR_OFFSETS[i].second);
         if (corner_n_col >= cols || corner_n_row >= rows) // Corner is out of map bounds
             continue;
 
-        uint8_t n1_col = current_col + static_cast<uint8_t>(TILE_NEIGHBOOR_OFFSETS[i].first);
-        uint8_t n1_row = current_row + static_cast<uint8_t>(TILE_NEIGHBOOR_OFFSETS[i].second);
-        uint8_t n2_col = current_col + static_cast<uint8_t>(TILE_NEIGHBOOR_OFFSETS[next & NEXT_SIDE_IDX_BIT_MASK].first);
-        uint8_t n2_row = current_row + static_cast<uint8_t>(TILE_NEIGHBOOR_OFFSETS[next & NEXT_SIDE_IDX_BIT_MASK].second);
-        std::shared_ptr<D_Tile> n1_tile = display_mat.at(n1_col).at(n1_row);
-        std::shared_ptr<D_Tile> c_tile = display_mat.at(corner_n_col).at(corner_n_row);
-        std::shared_ptr<D_Tile> n2_tile = display_mat.at(n2_col).at(n2_row);
-        if (!c_tile && !n1_tile && !n2_tile &&
+        uint16_t n1_col = current_col + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[i].first);
+        uint16_t n1_row = current_row + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[i].second);
+        uint16_t n2_col = current_col + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[next & NEXT_SIDE_IDX_BIT_MASK].first);
+        uint16_t n2_row = current_row + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[next & NEXT_SIDE_IDX_BIT_MASK].second);
+        bool n1_unset = MAP_UNSET_TILE_HANDLE == tile_grid[static_cast<size_t>(n1_row) * cols + n1_col];
+        bool c_unset = MAP_UNSET_TILE_HANDLE == tile_grid[static_cast<size_t>(corner_n_row) * cols + corner_n_col];
+        bool n2_unset = MAP_UNSET_TILE_HANDLE == tile_grid[static_cast<size_t>(n2_row) * cols + n2_col];
+        if (c_unset && n1_unset && n2_unset &&
             possible_connections.sides[i] &&
             possible_connections.sides[(next & NEXT_SIDE_IDX_BIT_MASK)])
         {
@@ -544,33 +1799,22 @@ void D_Map::calculate_connections_and_add_visitors(std::pair<uint8_t, uint8_t> c
     // Add the resulting possible connections to the to visit queue, required are not needed as the tile is already set
     for (size_t i = 0; i < MAX_NEIGHBOORS; i++)
     {
-        uint8_t n_col = current_col + static_cast<uint8_t>(TILE_NEIGHBOOR_OFFSETS[i].first);
-        uint8_t n_row = current_row + static_cast<uint8_t>(TILE_NEIGHBOOR_OFFSETS[i].second);
+        uint16_t n_col = current_col + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[i].first);
+        uint16_t n_row = current_row + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[i].second);
         if (n_col >= cols || n_row >= rows || // is out of map bounds
             !possible_connections.sides[i] || // has no possible connections
-            display_mat.at(n_col).at(n_row))  // or is already a set tile
+            MAP_UNSET_TILE_HANDLE != tile_grid[static_cast<size_t>(n_row) * cols + n_col]) // or is already set
         {
             continue;
         }
 
-        std::pair<uint8_t, uint8_t> n_pair = {n_col, n_row};
-        bool in_visit = false;
-        for (auto &&pair : to_visit)
-        {
-            if (pair == n_pair)
-            {
-                in_visit = true;
-                break;
-            }
-        }
-        if (!in_visit)
+        if (queue_visit(n_col, n_row))
         {
-            to_visit.push_back(n_pair);
-            LOG_DEBUG(std::format("Added col:{} row:{} to visit.", n_pair.first, n_pair.second));
+            LOG_TRACE(std::format("Added col:{} row:{} to visit.", n_col, n_row));
         }
     }
 
-    LOG_DEBUG(std::format("Setting connections, possible mask = [{}], required mask = [{}]",
+    LOG_TRACE(std::format("Setting connections, possible mask = [{}], required mask = [{}]",
                           possible_connections.mask,
                           required_connections.mask));
 }
@@ -586,15 +1830,486 @@ void D_Map::fill_empty_tiles()
         throw std::runtime_error(ERR_FORMAT("Empty Tile was null!"));
     }
 
-    for (uint8_t col = 0; col < cols; col++)
+    for (uint16_t &handle : tile_grid)
+    {
+        if (MAP_UNSET_TILE_HANDLE == handle)
+            handle = MAP_EMPTY_TILE_HANDLE;
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Marks a cell for redrawing on the next render().
+ *
+ * @param[in] col X coordinate in the map.
+ * @param[in] row Y coordinate in the map.
+ *
+ * @warning The point is not bounds checked.
+ **********************************************************************************************************************/
+void D_Map::mark_dirty(uint16_t col, uint16_t row)
+{
+    size_t cell = static_cast<size_t>(row) * cols + col;
+    if (dirty_words.size() <= cell / 64)
+        dirty_words.resize(cell / 64 + 1, 0);
+    dirty_words[cell / 64] |= 1ULL << (cell % 64);
+}
+
+/***********************************************************************************************************************
+ * @brief Marks every cell for redrawing on the next render(), cells whose tile did not change are still skipped.
+ **********************************************************************************************************************/
+void D_Map::mark_all_dirty()
+{
+    dirty_words.assign((tile_grid.size() + 63) / 64, UINT64_MAX);
+}
+
+/***********************************************************************************************************************
+ * @brief Draws all or part of a cell's tile into an image in TILE_IMAGE_FORMAT. Tile images are already in that format
+ * so each scanline is a single memcpy, solid tiles (ie the Empty_Tile) are filled with their pixel and unset cells are
+ * cleared. Any part of the area the image does not cover is cleared.
+ *
+ * @param[in] handle Tile handle of the cell.
+ * @param[in] level Level of the tile's image to draw from, 0 is full size. @see D_Tile::get_image_level()
+ * @param[in] src_x Pixel x within the tile's image of the area's left edge.
+ * @param[in] src_y Pixel y within the tile's image of the area's top edge.
+ * @param[in] cell_bits First byte of the area's top left pixel in the image drawn into.
+ * @param[in] cell_width Width of the area in pixels.
+ * @param[in] cell_height Height of the area in pixels.
+ * @param[in] bytes_per_line Bytes per scanline of the image drawn into.
+ *
+ * @note Only writes the area's own pixels, so different cells can be drawn from different threads.
+ **********************************************************************************************************************/
+void D_Map::draw_cell(uint16_t handle,
+                      size_t level,
+                      int src_x,
+                      int src_y,
+                      uchar *cell_bits,
+                      int cell_width,
+                      int cell_height,
+                      qsizetype bytes_per_line) const
+{
+    QImage const *image = nullptr;
+    QImage converted;
+    QRgb fill_pixel = 0;
+    D_Tile *tile = get_tile_from_handle(handle);
+    if (tile)
+    {
+        image = &tile->get_image_level(level);
+        if (tile->is_solid())
+        {
+            fill_pixel = tile->get_solid_pixel();
+            image = nullptr;
+        }
+        else if (TILE_IMAGE_FORMAT != image->format())
+        {
+            //! NOTE: Only reached for images set outside of D_Tile, which converts when decoding.
+            converted = image->convertToFormat(TILE_IMAGE_FORMAT);
+            image = &converted;
+        }
+    }
+
+    int const copy_width = image ? std::clamp(image->width() - src_x, 0, cell_width) : 0;
+    int const copy_height = image ? std::clamp(image->height() - src_y, 0, cell_height) : 0;
+    for (int y = 0; y < cell_height; y++)
+    {
+        QRgb *line = reinterpret_cast<QRgb *>(cell_bits + y * bytes_per_line);
+        int filled = 0;
+        if (y < copy_height)
+        {
+            std::memcpy(line,
+                        reinterpret_cast<QRgb const *>(image->constScanLine(src_y + y)) + src_x,
+                        static_cast<size_t>(copy_width) * sizeof(QRgb));
+            filled = copy_width;
+        }
+        std::fill(line + filled, line + cell_width, fill_pixel);
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Solves the solver's window in the Propagate mode. Every cell starts with a domain of every tile plus the empty
+ * slot, an entrance may be placed and then the open cell (one a placed tile connects into) with the smallest domain is
+ * given a tile until no open cells remain. Each choice is propagated to the neighboors domains and a domain that empties
+ * undoes the latest choices until the solver can continue. Cells never opened are left unset for the caller to fill.
+ *
+ * @param[in] place_entrance True to start from an entrance tile, false to start only from the tiles around the window.
+ *
+ * @throws std::runtime_error if no attempt could fill the window, ie the tile set cannot satisfy it at all.
+ **********************************************************************************************************************/
+void D_Map::solve_constraints(bool place_entrance)
+{
+    for (size_t attempt = 0; attempt < MAP_SOLVER_MAX_ATTEMPTS; attempt++)
+    {
+        reset_solver();
+        bool solved = place_entrance ? start_solver_at_entrance() : propagate();
+        while (solved)
+        {
+            uint32_t cell = 0;
+            bool found = false;
+            while (!solver.open_cells.empty() && !found)
+            {
+                std::pop_heap(solver.open_cells.begin(), solver.open_cells.end(), std::greater<>());
+                auto [key, open_cell] = solver.open_cells.back();
+                solver.open_cells.pop_back();
+                // Stale entries are left in the heap, only take one that matches the cell's current domain.
+                found = is_open_cell(open_cell) && solver.domain_sizes[open_cell] == static_cast<uint32_t>(key >> 32);
+                cell = open_cell;
+            }
+            if (!found)
+                return;
+
+            decide(cell);
+            while (solved && !propagate())
+                solved = backtrack();
+        }
+
+        LOG_DEBUG(std::format("Constraint solver restarting after {} backtracks.", solver.backtracks));
+    }
+
+    throw std::runtime_error(ERR_FORMAT(std::format("Constraint solver could not fill a {}x{} area in {} attempts!",
+                                                    solver.window_cols,
+                                                    solver.window_rows,
+                                                    MAP_SOLVER_MAX_ATTEMPTS)));
+}
+
+/***********************************************************************************************************************
+ * @brief Resets the solver's window for a new attempt. Every window cell is unset and gets every tile plus the empty
+ * slot, cells on the window's edge then lose the tiles that connect off the map or do not meet the fixed tile beside
+ * them and that is queued for propagation.
+ **********************************************************************************************************************/
+void D_Map::reset_solver()
+{
+    uint16_t const window_cols = solver.window_cols;
+    uint16_t const window_rows = solver.window_rows;
+    size_t const cell_count = static_cast<size_t>(window_cols) * window_rows;
+    size_t const word_count = tile_index->get_domain_word_count();
+    size_t const empty_slot = tile_index->get_empty_slot();
+
+    solver.word_count = word_count;
+    solver.trail_cells.clear();
+    solver.trail_sizes.clear();
+    solver.trail_words.clear();
+    solver.decisions.clear();
+    solver.open_cells.clear();
+    solver.changed_cells.clear();
+    solver.backtracks = 0;
+    solver.support_words.assign(word_count, 0);
+    solver.choice_words.assign(word_count, 0);
+    for (uint16_t row = 0; row < window_rows; row++)
+    {
+        auto row_start = tile_grid.begin() + static_cast<ptrdiff_t>(grid_cell(static_cast<uint32_t>(row) * window_cols));
+        std::fill(row_start, row_start + window_cols, MAP_UNSET_TILE_HANDLE);
+    }
+
+    // Every tile slot plus the empty slot
+    tile_index->filter(D_Tile_Set::All, CONNECTION_ZERO_MASK, CONNECTION_FULL_MASK, {.mask = CONNECTION_ZERO_MASK},
+                       canidate_words);
+    std::copy(canidate_words.begin(), canidate_words.end(), solver.choice_words.begin());
+    solver.choice_words[empty_slot / TILE_INDEX_WORD_BITS] |= 1ULL << (empty_slot % TILE_INDEX_WORD_BITS);
+
+    //! NOTE: assign() reuses the domains storage, so regenerating a map of the same size does not allocate.
+    solver.domain_words.resize(cell_count * word_count);
+    solver.domain_sizes.assign(cell_count, static_cast<uint32_t>(empty_slot + 1));
+    for (size_t cell = 0; cell < cell_count; cell++)
+        std::copy(solver.choice_words.begin(), solver.choice_words.end(), &solver.domain_words[cell * word_count]);
+
+    for (uint32_t cell = 0; cell < cell_count; cell++)
+    {
+        uint16_t col = static_cast<uint16_t>(cell % window_cols);
+        uint16_t row = static_cast<uint16_t>(cell / window_cols);
+        if (col && row && col < window_cols - 1 && row < window_rows - 1)
+        {
+            cell += window_cols - 3; // Skip to the right edge of this row
+            continue;
+        }
+
+        uint64_t *domain = &solver.domain_words[cell * word_count];
+        std::copy(domain, domain + word_count, solver.choice_words.begin());
+        for (size_t side = 0; side < MAX_NEIGHBOORS; side++)
+        {
+            uint16_t w_col = col + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[side].first);
+            uint16_t w_row = row + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[side].second);
+            if (w_col < window_cols && w_row < window_rows)
+                continue;
+
+            uint16_t n_col = solver.window_col + w_col;
+            uint16_t n_row = solver.window_row + w_row;
+            uint64_t const *allowed_words = nullptr;
+            if (n_col >= cols || n_row >= rows)
+            {
+                // Off the map, only tiles with no connections on this side may stay.
+                allowed_words = tile_index->side_pattern_domain(side, CONNECTION_ZERO_MASK);
+            }
+            else
+            {
+                // A fixed tile outside the window, only tiles meeting its facing side may stay.
+                uint16_t n_handle = tile_grid[static_cast<size_t>(n_row) * cols + n_col];
+                size_t n_slot = (MAP_UNSET_TILE_HANDLE == n_handle || MAP_EMPTY_TILE_HANDLE == n_handle) ? empty_slot : n_handle;
+                allowed_words = tile_index->compatible_domain(n_slot, TILE_NEIGHBOOR_SIDE_IDX_MIRRORS[side]);
+            }
+
+            for (size_t word = 0; word < word_count; word++)
+                solver.choice_words[word] &= allowed_words[word];
+        }
+
+        uint32_t size = 0;
+        for (size_t word = 0; word < word_count; word++)
+            size += static_cast<uint32_t>(std::popcount(solver.choice_words[word]));
+        set_domain(cell, solver.choice_words.data(), size);
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the tile grid index of a solver cell.
+ *
+ * @param[in] cell Row major cell index within the solver's window.
+ *
+ * @retval size_t Row major index into the tile grid.
+ **********************************************************************************************************************/
+size_t D_Map::grid_cell(uint32_t cell) const
+{
+    size_t row = solver.window_row + cell / solver.window_cols;
+    size_t col = solver.window_col + cell % solver.window_cols;
+    return row * cols + col;
+}
+
+/***********************************************************************************************************************
+ * @brief Places the entrance for a solver attempt, a random cell's domain is narrowed to the entrance tiles and
+ * propagated.
+ *
+ * @retval bool True if the entrance fits, false if the attempt should restart.
+ **********************************************************************************************************************/
+bool D_Map::start_solver_at_entrance()
+{
+    uint16_t ent_col = static_cast<uint16_t>(roll(solver.window_cols));
+    uint16_t ent_row = static_cast<uint16_t>(roll(solver.window_rows));
+    uint32_t cell = static_cast<uint32_t>(ent_row) * solver.window_cols + ent_col;
+
+    if (!propagate())
+        return false;
+
+    tile_index->filter(D_Tile_Set::Entrances, CONNECTION_ZERO_MASK, CONNECTION_FULL_MASK,
+                       {.mask = CONNECTION_ZERO_MASK}, canidate_words);
+    uint64_t const *domain = &solver.domain_words[cell * solver.word_count];
+    uint32_t size = 0;
+    for (size_t word = 0; word < solver.word_count; word++)
+    {
+        solver.choice_words[word] = domain[word] & (word < canidate_words.size() ? canidate_words[word] : 0);
+        size += static_cast<uint32_t>(std::popcount(solver.choice_words[word]));
+    }
+    if (!size)
+        return false;
+
+    set_domain(cell, solver.choice_words.data(), size);
+    return propagate();
+}
+
+/***********************************************************************************************************************
+ * @brief Checks if a cell is open, ie it has no tile yet and can no longer be empty.
+ *
+ * @param[in] cell Row major cell index within the solver's window.
+ *
+ * @retval bool True if the cell still needs a tile.
+ **********************************************************************************************************************/
+bool D_Map::is_open_cell(uint32_t cell) const
+{
+    size_t const empty_slot = tile_index->get_empty_slot();
+    uint64_t const empty_word = solver.domain_words[cell * solver.word_count + empty_slot / TILE_INDEX_WORD_BITS];
+    return !(empty_word & (1ULL << (empty_slot % TILE_INDEX_WORD_BITS))) && MAP_UNSET_TILE_HANDLE == tile_grid[grid_cell(cell)];
+}
+
+/***********************************************************************************************************************
+ * @brief Pushes an open cell onto the open cell heap keyed by its domain size, ties are broken randomly.
+ *
+ * @param[in] cell Row major cell index within the solver's window.
+ **********************************************************************************************************************/
+void D_Map::push_open_cell(uint32_t cell)
+{
+    uint64_t key = (static_cast<uint64_t>(solver.domain_sizes[cell]) << 32) | roll(UINT32_MAX);
+    solver.open_cells.push_back({key, cell});
+    std::push_heap(solver.open_cells.begin(), solver.open_cells.end(), std::greater<>());
+}
+
+/***********************************************************************************************************************
+ * @brief Replaces a cell's domain, recording the old domain on the trail so backtrack() can restore it, and queues the
+ * cell for propagation.
+ *
+ * @param[in] cell Row major cell index within the solver's window.
+ * @param[in] new_words New domain bitset.
+ * @param[in] new_size Number of slots in the new domain.
+ **********************************************************************************************************************/
+void D_Map::set_domain(uint32_t cell, uint64_t const *new_words, uint32_t new_size)
+{
+    uint64_t *domain = &solver.domain_words[cell * solver.word_count];
+    solver.trail_cells.push_back(cell);
+    solver.trail_sizes.push_back(solver.domain_sizes[cell]);
+    solver.trail_words.insert(solver.trail_words.end(), domain, domain + solver.word_count);
+
+    std::copy(new_words, new_words + solver.word_count, domain);
+    solver.domain_sizes[cell] = new_size;
+    solver.changed_cells.push_back(cell);
+    if (is_open_cell(cell))
+        push_open_cell(cell);
+}
+
+/***********************************************************************************************************************
+ * @brief Propagates every changed domain to the neighboors of its cell within the window, a neighboor keeps only the
+ * slots that can face at least one slot left in the changed domain. Neighboors that change are propagated in turn.
+ *
+ * @retval bool True once every change is propagated, false if a domain emptied.
+ **********************************************************************************************************************/
+bool D_Map::propagate()
+{
+    uint16_t const window_cols = solver.window_cols;
+    uint16_t const window_rows = solver.window_rows;
+    while (!solver.changed_cells.empty())
     {
-        for (uint8_t row = 0; row < rows; row++)
+        uint32_t cell = solver.changed_cells.back();
+        solver.changed_cells.pop_back();
+        uint16_t col = static_cast<uint16_t>(cell % window_cols);
+        uint16_t row = static_cast<uint16_t>(cell / window_cols);
+        uint64_t const *domain = &solver.domain_words[cell * solver.word_count];
+
+        // A single slot left, ie a placed tile, narrows its neighboors straight from the compatibility table.
+        size_t single_slot = SIZE_MAX;
+        if (1 == solver.domain_sizes[cell])
+        {
+            size_t word = 0;
+            while (!domain[word])
+                word++;
+            single_slot = word * TILE_INDEX_WORD_BITS + static_cast<size_t>(std::countr_zero(domain[word]));
+        }
+
+        for (size_t side = 0; side < MAX_NEIGHBOORS; side++)
         {
-            std::shared_ptr<D_Tile> tile = display_mat.at(col).at(row);
-            if (!tile)
+            uint16_t n_col = col + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[side].first);
+            uint16_t n_row = row + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[side].second);
+            if (n_col >= window_cols || n_row >= window_rows) // ie out of window bounds, fixed or off the map
+                continue;
+
+            //! NOTE: A placed neighboor already narrowed this cell, so this cell's domain always supports it.
+            uint32_t n_cell = static_cast<uint32_t>(n_row) * window_cols + n_col;
+            if (MAP_UNSET_TILE_HANDLE != tile_grid[(static_cast<size_t>(solver.window_row) + n_row) * cols + solver.window_col + n_col])
+                continue;
+
+            uint64_t const *support = nullptr;
+            if (SIZE_MAX != single_slot)
             {
-                swap_tile(col, row, Empty_Tile);
+                support = tile_index->compatible_domain(single_slot, side);
             }
+            else
+            {
+                tile_index->side_support(TILE_NEIGHBOOR_SIDE_IDX_MIRRORS[side], domain, solver.support_words.data());
+                support = solver.support_words.data();
+            }
+
+            uint64_t const *n_domain = &solver.domain_words[n_cell * solver.word_count];
+            uint32_t size = 0;
+            bool changed = false;
+            for (size_t word = 0; word < solver.word_count; word++)
+            {
+                solver.choice_words[word] = n_domain[word] & support[word];
+                changed |= solver.choice_words[word] != n_domain[word];
+                size += static_cast<uint32_t>(std::popcount(solver.choice_words[word]));
+            }
+
+            if (!changed)
+                continue;
+            if (!size)
+                return false;
+            set_domain(n_cell, solver.choice_words.data(), size);
         }
     }
+    return true;
+}
+
+/***********************************************************************************************************************
+ * @brief Gives an open cell a tile from its domain. Like the Greedy mode each side facing a window cell without a tile
+ * only allows a connection at the map's connection chance, unless no tile in the domain avoids connecting there.
+ *
+ * @param[in] cell Row major cell index of an open cell within the solver's window.
+ **********************************************************************************************************************/
+void D_Map::decide(uint32_t cell)
+{
+    uint16_t col = static_cast<uint16_t>(cell % solver.window_cols);
+    uint16_t row = static_cast<uint16_t>(cell / solver.window_cols);
+    uint64_t const *domain = &solver.domain_words[cell * solver.word_count];
+    std::copy(domain, domain + solver.word_count, solver.choice_words.begin());
+
+    for (size_t side = 0; side < MAX_NEIGHBOORS; side++)
+    {
+        uint16_t n_col = col + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[side].first);
+        uint16_t n_row = row + static_cast<uint16_t>(TILE_NEIGHBOOR_OFFSETS[side].second);
+        if (n_col >= solver.window_cols || n_row >= solver.window_rows ||
+            MAP_UNSET_TILE_HANDLE != tile_grid[grid_cell(static_cast<uint32_t>(n_row) * solver.window_cols + n_col)] ||
+            roll(ONE_HUNDRED_PERCENT + 1) <= connection_chance)
+        {
+            continue;
+        }
+
+        // Don't connect
+        uint64_t const *zero_words = tile_index->side_pattern_domain(side, CONNECTION_ZERO_MASK);
+        for (size_t word = 0; word < solver.word_count; word++)
+            solver.choice_words[word] &= zero_words[word];
+    }
+
+    size_t choice_count = 0;
+    for (size_t word = 0; word < solver.word_count; word++)
+        choice_count += static_cast<size_t>(std::popcount(solver.choice_words[word]));
+    if (!choice_count)
+    {
+        std::copy(domain, domain + solver.word_count, solver.choice_words.begin());
+        choice_count = solver.domain_sizes[cell];
+    }
+
+    size_t slot = tile_index->nth_canidate(solver.choice_words, roll(static_cast<uint32_t>(choice_count)));
+    solver.decisions.push_back({.cell = cell, .handle = static_cast<uint16_t>(slot), .trail_mark = solver.trail_cells.size()});
+    tile_grid[grid_cell(cell)] = static_cast<uint16_t>(slot);
+
+    std::fill(solver.choice_words.begin(), solver.choice_words.end(), 0);
+    solver.choice_words[slot / TILE_INDEX_WORD_BITS] = 1ULL << (slot % TILE_INDEX_WORD_BITS);
+    set_domain(cell, solver.choice_words.data(), 1);
+}
+
+/***********************************************************************************************************************
+ * @brief Undoes the latest decision and removes its tile from that cell's domain, undoing further decisions while that
+ * empties the domain.
+ *
+ * @retval bool True if the solver can continue, false if the attempt should restart, ie every decision was undone or
+ * MAP_SOLVER_MAX_BACKTRACKS was reached.
+ **********************************************************************************************************************/
+bool D_Map::backtrack()
+{
+    while (!solver.decisions.empty() && solver.backtracks++ < MAP_SOLVER_MAX_BACKTRACKS)
+    {
+        Solver_State::Decision decision = solver.decisions.back();
+        solver.decisions.pop_back();
+        solver.changed_cells.clear();
+
+        // Restore every domain changed since the decision, newest first.
+        while (solver.trail_cells.size() > decision.trail_mark)
+        {
+            uint32_t cell = solver.trail_cells.back();
+            size_t trail_idx = solver.trail_cells.size() - 1;
+            std::copy(&solver.trail_words[trail_idx * solver.word_count],
+                      &solver.trail_words[trail_idx * solver.word_count] + solver.word_count,
+                      &solver.domain_words[cell * solver.word_count]);
+            solver.domain_sizes[cell] = solver.trail_sizes.back();
+            solver.trail_cells.pop_back();
+            solver.trail_sizes.pop_back();
+            solver.trail_words.resize(trail_idx * solver.word_count);
+            if (is_open_cell(cell))
+                push_open_cell(cell);
+        }
+        tile_grid[grid_cell(decision.cell)] = MAP_UNSET_TILE_HANDLE;
+        LOG_TRACE(std::format("Backtracked from cell {} tile {}.", decision.cell, decision.handle));
+
+        uint32_t size = solver.domain_sizes[decision.cell] - 1;
+        if (!size)
+            continue;
+
+        uint64_t const *domain = &solver.domain_words[decision.cell * solver.word_count];
+        std::copy(domain, domain + solver.word_count, solver.choice_words.begin());
+        solver.choice_words[decision.handle / TILE_INDEX_WORD_BITS] &= ~(1ULL << (decision.handle % TILE_INDEX_WORD_BITS));
+        set_domain(decision.cell, solver.choice_words.data(), size);
+        return true;
+    }
+    return false;
 }
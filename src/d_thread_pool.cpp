@@ -0,0 +1,255 @@
+/***********************************************************************************************************************
+ * @date 2026-10-16
+ * @author Gregory Nitch
+ *
+ * @brief D_Thread_Pool implementation functions.
+ **********************************************************************************************************************/
+
+/*
+========================================================================================================================
+- - System Includes - -
+========================================================================================================================
+*/
+
+#include <cstdint>
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+#include <iostream>
+
+/*
+========================================================================================================================
+- - Local Includes - -
+========================================================================================================================
+*/
+
+#include "d_thread_pool.hpp"
+#include "d_builder_common.hpp"
+
+/*
+========================================================================================================================
+- - Static Members - -
+========================================================================================================================
+*/
+
+thread_local D_Thread_Pool *D_Thread_Pool::worker_pool = nullptr;
+thread_local size_t D_Thread_Pool::worker_index = 0;
+
+/*
+========================================================================================================================
+- - Class Methods - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Constructor for a D_Thread_Pool, starts the worker threads which then wait for run() to give them jobs.
+ *
+ * @param[in] thread_count Number of worker threads to start.
+ *
+ * @throws std::invalid_argument if the thread count is zero.
+ **********************************************************************************************************************/
+D_Thread_Pool::D_Thread_Pool(size_t thread_count)
+{
+    if (!thread_count)
+        throw std::invalid_argument(ERR_FORMAT("Thread pool needs at least one thread!"));
+
+    queues.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; i++)
+        queues.push_back(std::make_unique<Worker_Queue>());
+
+    threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; i++)
+        threads.emplace_back(&D_Thread_Pool::worker_loop, this, i);
+
+    LOG_DEBUG(std::format("Started thread pool with {} workers.", thread_count));
+}
+
+/***********************************************************************************************************************
+ * @brief Destructor for a D_Thread_Pool, stops and joins the worker threads.
+ **********************************************************************************************************************/
+D_Thread_Pool::~D_Thread_Pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(state_mtx);
+        stopping = true;
+    }
+    work_cv.notify_all();
+
+    for (auto &thread : threads)
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the number of workers in the pool.
+ *
+ * @retval size_t Worker count, worker indexs passed to jobs are in [0, size()).
+ **********************************************************************************************************************/
+size_t D_Thread_Pool::size() const
+{
+    return threads.size();
+}
+
+/***********************************************************************************************************************
+ * @brief Runs a job for every index in [0, job_count) across the pool's workers and waits for them to finish.
+ *
+ * @param[in] job_count Number of jobs to run.
+ * @param[in] job Job to run, called with the index of the job and the index of the worker running it. A worker runs one
+ * job at a time, so state indexed by worker needs no locking.
+ *
+ * @throws Rethrows the first exception thrown by a job once all workers are idle, remaining jobs are skipped.
+ *
+ * @note Called from within one of the pool's own jobs the jobs run inline on that worker, in order and with its worker
+ * index, rather than waiting on workers that are already busy. Jobs sharing state by worker index must allow for this.
+ **********************************************************************************************************************/
+void D_Thread_Pool::run(size_t job_count, std::function<void(size_t job_idx, size_t worker_idx)> const &job)
+{
+    if (!job_count)
+        return;
+
+    if (this == worker_pool)
+    {
+        for (size_t job_idx = 0; job_idx < job_count; job_idx++)
+            job(job_idx, worker_index);
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_mtx);
+
+    //! NOTE: Contiguous ranges keep neighbooring jobs on one worker until stealing is needed.
+    size_t worker_count = queues.size();
+    for (size_t worker = 0; worker < worker_count; worker++)
+    {
+        size_t begin = job_count * worker / worker_count;
+        size_t end = job_count * (worker + 1) / worker_count;
+        std::lock_guard<std::mutex> queue_lock(queues[worker]->mtx);
+        for (size_t job_idx = begin; job_idx < end; job_idx++)
+            queues[worker]->jobs.push_back(job_idx);
+    }
+
+    std::exception_ptr run_exception = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(state_mtx);
+        current_job = &job;
+        remaining_jobs.store(job_count);
+        cancelled.store(false);
+        job_exception = nullptr;
+        run_count++;
+        work_cv.notify_all();
+
+        done_cv.wait(lock, [this]()
+                     { return !remaining_jobs.load() && !active_workers; });
+        current_job = nullptr;
+        run_exception = job_exception;
+    }
+
+    if (run_exception)
+        std::rethrow_exception(run_exception);
+}
+
+/***********************************************************************************************************************
+ * @brief Gets a pool shared by the whole application, started on first use with one worker per available thread.
+ *
+ * @retval D_Thread_Pool The shared pool.
+ **********************************************************************************************************************/
+D_Thread_Pool &D_Thread_Pool::shared()
+{
+    static D_Thread_Pool shared_pool(available_threads());
+    return shared_pool;
+}
+
+/*
+========================================================================================================================
+- - Private Functions - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Main loop of a worker thread, waits for a run and then takes jobs until no worker has any left.
+ *
+ * @param[in] worker_idx Index of this worker's queue.
+ **********************************************************************************************************************/
+void D_Thread_Pool::worker_loop(size_t worker_idx)
+{
+    worker_pool = this;
+    worker_index = worker_idx;
+    uint64_t seen_run = 0;
+    for (;;)
+    {
+        std::function<void(size_t, size_t)> const *job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(state_mtx);
+            work_cv.wait(lock, [&]()
+                         { return stopping || (current_job && run_count != seen_run); });
+            if (stopping)
+                return;
+            seen_run = run_count;
+            job = current_job;
+            active_workers++;
+        }
+
+        size_t job_idx = 0;
+        while (take_job(worker_idx, job_idx))
+        {
+            if (!cancelled.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    (*job)(job_idx, worker_idx);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(state_mtx);
+                    if (!job_exception)
+                        job_exception = std::current_exception();
+                    cancelled.store(true);
+                }
+            }
+            remaining_jobs.fetch_sub(1);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state_mtx);
+            active_workers--;
+        }
+        done_cv.notify_all();
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Takes the next job for a worker, from the front of its own queue or else from the back of another's.
+ *
+ * @param[in] worker_idx Index of the worker taking a job.
+ * @param[out] job_idx Index of the job taken.
+ *
+ * @retval bool True if a job was taken, false if every queue is empty.
+ **********************************************************************************************************************/
+bool D_Thread_Pool::take_job(size_t worker_idx, size_t &job_idx)
+{
+    {
+        Worker_Queue &own = *queues[worker_idx];
+        std::lock_guard<std::mutex> lock(own.mtx);
+        if (!own.jobs.empty())
+        {
+            job_idx = own.jobs.front();
+            own.jobs.pop_front();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < queues.size(); offset++)
+    {
+        Worker_Queue &victim = *queues[(worker_idx + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mtx);
+        if (!victim.jobs.empty())
+        {
+            job_idx = victim.jobs.back();
+            victim.jobs.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
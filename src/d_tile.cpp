@@ -23,6 +23,10 @@
 #include <exception>
 #include <bit>
 #include <format>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <cstring>
 
 /*
 ========================================================================================================================
@@ -31,8 +35,11 @@
 */
 
 #include <QImage>
+#include <QImageReader>
+#include <QSize>
 #include <QTransform>
 #include <QString>
+#include <QFile>
 
 /*
 ========================================================================================================================
@@ -41,6 +48,7 @@
 */
 
 #include "d_tile.hpp"
+#include "d_tile_index.hpp"
 #include "d_builder_common.hpp"
 
 /*
@@ -114,6 +122,89 @@
  **********************************************************************************************************************/
 #define TILE_SIDE_CONNECTION_SIZE (8)
 
+/***********************************************************************************************************************
+ * @brief Magic bytes at the start of a tile manifest, 'DTMF'.
+ **********************************************************************************************************************/
+#define TILE_MANIFEST_MAGIC (0x464D'5444U)
+
+/***********************************************************************************************************************
+ * @brief Version of the tile manifest layout, bump this whenever the header or record layouts change.
+ **********************************************************************************************************************/
+#define TILE_MANIFEST_VERSION (1U)
+
+/***********************************************************************************************************************
+ * @brief Record index used in a manifest tile record that has no base tile, ie it is not a permutation.
+ **********************************************************************************************************************/
+#define TILE_MANIFEST_NO_BASE (0xFFFF'FFFFU)
+
+/***********************************************************************************************************************
+ * @brief Manifest tile record flag bits.
+ **********************************************************************************************************************/
+#define TILE_MANIFEST_ENTRANCE_FLAG (0x01U)
+#define TILE_MANIFEST_EXIT_FLAG (0x02U)
+#define TILE_MANIFEST_PERMUTABLE_FLAG (0x04U)
+#define TILE_MANIFEST_FLIPPABLE_FLAG (0x08U)
+#define TILE_MANIFEST_FLIPPED_FLAG (0x10U)
+
+/*
+========================================================================================================================
+- - Manifest Layout - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Header at the start of a tile manifest file. The file is laid out as the header, then tile_count
+ * Tile_Manifest_Records, then string_count uint32_t string offsets (plus one end offset) and finally the string bytes.
+ *
+ * @members :
+ *      @public uint32_t magic = TILE_MANIFEST_MAGIC.
+ *      @public uint32_t version = TILE_MANIFEST_VERSION.
+ *      @public uint64_t source_stamp = Stamp of the tile directory the manifest was built from. @see stamp_directory()
+ *      @public uint32_t tile_count = Number of tile records.
+ *      @public uint32_t string_count = Number of interned strings.
+ *      @public uint64_t records_offset = Byte offset of the first tile record.
+ *      @public uint64_t strings_offset = Byte offset of the string offset table.
+ **********************************************************************************************************************/
+struct Tile_Manifest_Header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t source_stamp;
+    uint32_t tile_count;
+    uint32_t string_count;
+    uint64_t records_offset;
+    uint64_t strings_offset;
+};
+static_assert(sizeof(Tile_Manifest_Header) == 40, "Tile manifest header layout changed, bump TILE_MANIFEST_VERSION!");
+
+/***********************************************************************************************************************
+ * @brief A single tile in a tile manifest, records are ordered by id.
+ *
+ * @members :
+ *      @public uint64_t id = Id of the tile.
+ *      @public uint32_t connections = Connection mask of the tile.
+ *      @public uint32_t name_str = Interned string index of the tile name.
+ *      @public uint32_t theme_str = Interned string index of the tile theme.
+ *      @public uint32_t path_str = Interned string index of the tile image path.
+ *      @public uint32_t base_record = Record index of the tile this permutation was made from, or TILE_MANIFEST_NO_BASE.
+ *      @public uint8_t flags = TILE_MANIFEST_*_FLAG bits.
+ *      @public uint8_t rotation = Connection_Rotations value of the tile.
+ *      @public uint16_t reserved = Padding, always zero.
+ **********************************************************************************************************************/
+struct Tile_Manifest_Record
+{
+    uint64_t id;
+    uint32_t connections;
+    uint32_t name_str;
+    uint32_t theme_str;
+    uint32_t path_str;
+    uint32_t base_record;
+    uint8_t flags;
+    uint8_t rotation;
+    uint16_t reserved;
+};
+static_assert(sizeof(Tile_Manifest_Record) == 32, "Tile manifest record layout changed, bump TILE_MANIFEST_VERSION!");
+
 /***********************************************************************************************************************
  * @brief Global id counter for D_Tile objects.
  *
@@ -144,80 +235,8 @@ std::atomic<uint64_t> D_Tile::id_counter{0};
  * @throws std::invalid_argument if in_path filename is empty, if name member ends up empty, if theme member ends up
  * empty, or if it is labeled as both an entrance and an exit.
  **********************************************************************************************************************/
-D_Tile::D_Tile(std::filesystem::path const &in_path)
+D_Tile::D_Tile(std::filesystem::path const &in_path) : D_Tile(in_path, id_counter.fetch_add(1))
 {
-    if (in_path.filename().generic_string().empty())
-        throw std::invalid_argument(ERR_FORMAT("Empty filename in path given to D_Tile()!"));
-
-    std::vector<std::string> file_tokens;
-    std::string file_token;
-    std::vector<std::string> connection_tokens;
-    std::string connection_token;
-    std::stringstream file_str_stream(in_path.filename().generic_string());
-    char const semi_colon = ';';
-    char const comma = ',';
-
-    file_tokens.reserve(FILE_NAME_TOKEN_NUM);
-    connection_tokens.reserve(TILE_CONNECTION_MAX);
-
-    // Parse info
-    while (std::getline(file_str_stream, file_token, semi_colon))
-    {
-        file_tokens.push_back(file_token);
-    }
-
-    std::stringstream connection_string_stream(file_tokens.at(TILE_CON_IDX));
-    while (std::getline(connection_string_stream, connection_token, comma))
-    {
-        connection_tokens.push_back(connection_token);
-    }
-
-    // Remove '.jpg'
-    [[maybe_unused]] std::stringstream err;
-    size_t idx = file_tokens.at(TILE_FLIP_FLG_IDX).find_first_of('.');
-    if (idx == std::string::npos)
-    {
-        err << "No file type in file path!";
-        err << to_string();
-        throw std::invalid_argument(ERR_FORMAT(err.str()));
-    }
-    file_tokens.at(TILE_FLIP_FLG_IDX) = file_tokens.at(TILE_FLIP_FLG_IDX).erase(idx);
-
-    // Set members
-    path = in_path;
-    name = file_tokens.at(TILE_NAME_IDX);
-    theme = file_tokens.at(TILE_THEME_IDX);
-    id = id_counter.fetch_add(1);
-    map_connection_tokens(connection_tokens);
-    is_entrance_flag = file_tokens.at(TILE_ENT_FLG_IDX).compare("true") ? false : true;
-    is_exit_flag = file_tokens.at(TILE_EXT_FLG_IDX).compare("true") ? false : true;
-    is_permutateable_flag = file_tokens.at(TILE_PERM_FLG_IDX).compare("true") ? false : true;
-    is_flippable_flag = file_tokens.at(TILE_FLIP_FLG_IDX).compare("true") ? false : true;
-
-    if (name.empty())
-    {
-        err << "Tile name found to be empty at end of D_Tile()!:";
-        err << to_string();
-        throw std::invalid_argument(ERR_FORMAT(err.str()));
-    }
-    if (theme.empty())
-    {
-        err << "Tile theme found to be empty at end of D_Tile!:";
-        err << to_string();
-        throw std::invalid_argument(ERR_FORMAT(err.str()));
-    }
-    if (is_entrance() && is_exit())
-    {
-        err << "A tile cannot be both an entrance and an exit!:";
-        err << to_string();
-        throw std::invalid_argument(ERR_FORMAT(err.str()));
-    }
-    if (is_flippable() && !is_permutateable())
-    {
-        err << "A tile cannot be flippable and not be permutateable!:";
-        err << to_string();
-        throw std::invalid_argument(ERR_FORMAT(err.str()));
-    }
 }
 
 /***********************************************************************************************************************
@@ -235,48 +254,61 @@ D_Tile::~D_Tile()
  * @param[in] dir_path Directory path to a group of images to load.
  * @param[in] loaded_path Directory path to move the loaded images too. Defaults to an empty path incase we have already
  * copied and generated tiles in the loaded directory.
+ * @param[in] load_mode Whether images are decoded now or on first use, workers that only generate layouts should load
+ * lazily so only the tiles that are actually drawn are ever decoded.
  *
  * @note Does not generate permutations in the global maps, if that is required call generate_tiles. Doing so will also
- * create images for the application to use.
+ * create images for the application to use. The global Tile_Index is rebuilt over the loaded tiles.
+ *
+ * @note Filenames are parsed, copied and decoded on a pool of worker threads. Paths are sorted and ids are reserved
+ * before the workers start, so the same directory always loads with the same ids and the global maps are filled in
+ * that same order afterwards.
  **********************************************************************************************************************/
-void D_Tile::load_tiles(std::filesystem::path const &dir_path, std::filesystem::path const &loaded_path)
+void D_Tile::load_tiles(std::filesystem::path const &dir_path,
+                        std::filesystem::path const &loaded_path,
+                        Image_Load_Mode load_mode)
 {
     LOG_DEBUG("Loading Tiles...");
     if (dir_path.empty())
-        std::invalid_argument(ERR_FORMAT("Given empty path to loading function!"));
+        throw std::invalid_argument(ERR_FORMAT("Given empty path to loading function!"));
 
-    size_t tile_count = 0;
-    std::vector<std::shared_ptr<D_Tile>> tiles;
+    std::vector<std::filesystem::path> tile_paths;
     for (std::filesystem::directory_entry const &dir_entry : std::filesystem::directory_iterator{dir_path})
     {
         if (dir_entry.is_directory())
             continue;
-        tile_count++;
+        tile_paths.push_back(dir_entry.path());
     }
+    std::sort(tile_paths.begin(), tile_paths.end());
 
     std::stringstream ss;
     ss << "Found ";
-    ss << tile_count;
+    ss << tile_paths.size();
     ss << " input tiles.";
     LOG_DEBUG(ss.str());
 
+    // Parse, copy and decode each tile on the worker pool, each job only writes its own slot.
+    uint64_t const base_id = id_counter.fetch_add(tile_paths.size());
+    std::vector<std::shared_ptr<D_Tile>> tiles(tile_paths.size(), nullptr);
+    run_parallel(tile_paths.size(), [&](size_t idx)
+                 {
+                     std::shared_ptr<D_Tile> tile(new D_Tile(tile_paths[idx], base_id + idx));
+                     if (!loaded_path.empty())
+                     {
+                         tile->copy_tile_img(loaded_path);
+                     }
+                     //! NOTE: We only load the tile image after we have ensured it is in the proper directory.
+                     if (Image_Load_Mode::Eager == load_mode)
+                         tile->set_image(std::make_shared<QImage>(QString::fromStdString(tile->path.generic_string())));
+                     else if (Image_Load_Mode::Preview == load_mode)
+                         tile->preview_image = tile->decode_preview();
+                     tiles[idx] = tile;
+                 });
+
     size_t entrance_count = 0;
     size_t exit_count = 0;
-    Tile_Map.reserve(tile_count);
-    tiles.reserve(tile_count);
-    for (std::filesystem::directory_entry const &dir_entry : std::filesystem::directory_iterator{dir_path})
+    for (auto const &tile : tiles)
     {
-        if (dir_entry.is_directory())
-            continue;
-        std::shared_ptr<D_Tile> tile = std::make_shared<D_Tile>(dir_entry.path());
-        if (!loaded_path.empty())
-        {
-            tile->copy_tile_img(loaded_path);
-        }
-        //! NOTE: We only load the tile image after we have ensured it is in the proper directory.
-        tile->image = std::make_shared<QImage>(QString::fromStdString(tile->path.generic_string()));
-        tiles.push_back(tile);
-
         if (tile->is_entrance())
             entrance_count++;
         if (tile->is_exit())
@@ -285,9 +317,10 @@ void D_Tile::load_tiles(std::filesystem::path const &dir_path, std::filesystem::
             Empty_Tile = tile;
     }
 
-    Entrance_Map.reserve(entrance_count);
-    Exit_Map.reserve(exit_count);
-    for (auto tile : tiles)
+    Tile_Map.reserve(Tile_Map.size() + tiles.size());
+    Entrance_Map.reserve(Entrance_Map.size() + entrance_count);
+    Exit_Map.reserve(Exit_Map.size() + exit_count);
+    for (auto const &tile : tiles)
     {
         std::pair<uint64_t, std::shared_ptr<D_Tile>> tile_pair = {tile->id, tile};
         auto emplace_pair = Tile_Map.emplace(tile_pair);
@@ -308,39 +341,170 @@ void D_Tile::load_tiles(std::filesystem::path const &dir_path, std::filesystem::
                 throw std::runtime_error(ERR_FORMAT("Failed placing a tile in the Exit_Map during loading!"));
         }
 
-        LOG_DEBUG(std::format("{}:{}", "Loaded Tile", tile->to_string()));
+        LOG_TRACE(std::format("{}:{}", "Loaded Tile", tile->to_string()));
     }
+
+    Tile_Index = std::make_shared<D_Tile_Index const>(Tile_Map);
 }
 
 /***********************************************************************************************************************
- * @brief Generates tiles from the D_Tiles loaded in load_tiles(), this will also create permutation images of
- * permutable tiles and save them.
+ * @brief Brings the loaded directory up to date with the input directory. Each input tile is hashed by its filename and
+ * content, and only tiles whose hash differs from the cache index (or that are missing from the loaded directory) are
+ * copied. Files in the loaded directory that no longer have an input tile are removed.
+ *
+ * @param[in] dir_path Input directory of tiles.
+ * @param[in] loaded_path Loaded directory to bring up to date.
+ * @param[in] cache_path Cache index of the hashes of the tiles in the loaded directory, rewritten after syncing.
+ *
+ * @retval bool True if any tile was copied or removed, ie anything built from the loaded directory is now stale.
  *
- * @note Generates permutations in the global maps.
+ * @note Hashing and copying run on the worker pool.
  *
- * @throws std::runtime_error if it encoutners a nullptr in the Tile_Map.
+ * @throws std::invalid_argument on an empty path, std::runtime_error if a tile cannot be copied or removed.
  **********************************************************************************************************************/
-void D_Tile::generate_tiles()
+bool D_Tile::sync_loaded_tiles(std::filesystem::path const &dir_path,
+                               std::filesystem::path const &loaded_path,
+                               std::filesystem::path const &cache_path)
+{
+    LOG_DEBUG("Syncing loaded tiles...");
+    if (dir_path.empty() || loaded_path.empty() || cache_path.empty())
+        throw std::invalid_argument(ERR_FORMAT("Given empty path to tile syncing function!"));
+
+    // Read the previous hashes, lines are "<hash>\t<filename>".
+    std::unordered_map<std::string, uint64_t> cached_hashes;
+    std::ifstream cache_in(cache_path);
+    for (std::string line; std::getline(cache_in, line);)
+    {
+        size_t tab_idx = line.find('\t');
+        if (std::string::npos == tab_idx)
+            continue;
+        try
+        {
+            cached_hashes[line.substr(tab_idx + 1)] = std::stoull(line.substr(0, tab_idx), nullptr, 16);
+        }
+        catch (std::exception const &)
+        {
+            continue; // A damaged line only costs us a copy.
+        }
+    }
+    cache_in.close();
+
+    std::vector<std::filesystem::path> tile_paths;
+    for (std::filesystem::directory_entry const &dir_entry : std::filesystem::directory_iterator{dir_path})
+    {
+        if (dir_entry.is_directory())
+            continue;
+        tile_paths.push_back(dir_entry.path());
+    }
+    std::sort(tile_paths.begin(), tile_paths.end());
+
+    std::vector<uint64_t> hashes(tile_paths.size(), 0);
+    std::vector<uint8_t> copied(tile_paths.size(), 0);
+    run_parallel(tile_paths.size(), [&](size_t idx)
+                 {
+                     std::string const filename = tile_paths[idx].filename().generic_string();
+                     std::filesystem::path const loaded_tile_path = loaded_path / filename;
+                     hashes[idx] = hash_tile_file(tile_paths[idx]);
+
+                     auto cached = cached_hashes.find(filename);
+                     if (cached != cached_hashes.end() &&
+                         cached->second == hashes[idx] &&
+                         std::filesystem::exists(loaded_tile_path))
+                         return;
+
+                     try
+                     {
+                         std::filesystem::copy(tile_paths[idx], loaded_tile_path, std::filesystem::copy_options::overwrite_existing);
+                     }
+                     catch (std::filesystem::filesystem_error &fs_e)
+                     {
+                         std::stringstream err;
+                         err << "Unable to copy tile image. Filesystem error was: ";
+                         err << fs_e.what();
+                         throw std::runtime_error(ERR_FORMAT(err.str()));
+                     }
+                     copied[idx] = 1; });
+
+    // Remove orphans, ie loaded files whose input tile is gone.
+    std::unordered_map<std::string, uint64_t> new_hashes;
+    new_hashes.reserve(tile_paths.size());
+    for (size_t idx = 0; idx < tile_paths.size(); idx++)
+        new_hashes.emplace(tile_paths[idx].filename().generic_string(), hashes[idx]);
+
+    size_t removed_count = 0;
+    for (std::filesystem::directory_entry const &dir_entry : std::filesystem::directory_iterator{loaded_path})
+    {
+        if (dir_entry.is_directory() || new_hashes.contains(dir_entry.path().filename().generic_string()))
+            continue;
+
+        std::error_code ec;
+        if (!std::filesystem::remove(dir_entry.path(), ec) && ec)
+            throw std::runtime_error(ERR_FORMAT(std::format("Unable to remove orphaned tile {}: {}",
+                                                            dir_entry.path().generic_string(),
+                                                            ec.message())));
+        removed_count++;
+    }
+
+    std::ofstream cache_out(cache_path, std::ios::trunc);
+    for (size_t idx = 0; idx < tile_paths.size(); idx++)
+        cache_out << std::format("{:016x}\t{}\n", hashes[idx], tile_paths[idx].filename().generic_string());
+    if (!cache_out)
+        throw std::runtime_error(ERR_FORMAT("Failed writing the tile cache index!"));
+
+    size_t copied_count = static_cast<size_t>(std::count(copied.begin(), copied.end(), 1));
+    LOG_DEBUG(std::format("Synced loaded tiles: {} copied, {} unchanged, {} orphans removed.",
+                          copied_count,
+                          tile_paths.size() - copied_count,
+                          removed_count));
+    return copied_count || removed_count;
+}
+
+/***********************************************************************************************************************
+ * @brief Generates tiles from the D_Tiles loaded in load_tiles(), permutations share their base tile's image and only
+ * carry their rotation and flip, @see get_image().
+ *
+ * @note Generates permutations in the global maps and rebuilds the global Tile_Index.
+ *
+ * @note No permutation images are encoded or written, so this is cheap enough to call on every start.
+ *
+ * @param[in] manifest_path Path to write a tile manifest to once generation is done, @see load_manifest(). Defaults to
+ * an empty path in which case no manifest is written.
+ *
+ * @throws std::runtime_error if it encoutners a nullptr in the Tile_Map, or if the manifest cannot be written.
+ **********************************************************************************************************************/
+void D_Tile::generate_tiles(std::filesystem::path const &manifest_path)
 {
     LOG_DEBUG("Generating Tiles...");
 
     size_t entrance_count = 0;
     size_t exit_count = 0;
     std::vector<std::shared_ptr<D_Tile>> permutations;
+    std::vector<std::shared_ptr<D_Tile>> permutateables;
+    auto const gen_start = std::chrono::steady_clock::now();
 
     // For each tile in global check for permutables
-    for (auto pair : Tile_Map)
+    permutateables.reserve(Tile_Map.size());
+    for (auto const &pair : Tile_Map)
     {
-        std::shared_ptr<D_Tile> tile = pair.second;
+        std::shared_ptr<D_Tile> const &tile = pair.second;
         if (nullptr != tile && tile->is_permutateable())
         {
-            permutate(tile, permutations, entrance_count, exit_count);
+            permutateables.push_back(tile);
         }
         else if (nullptr == tile)
             throw std::runtime_error(ERR_FORMAT("Found nullptr in tile global map!"));
     }
 
-    // Generate images and load them to the global map.
+    //! NOTE: Permutate in id order so that permutation ids do not depend on the Tile_Map's iteration order.
+    std::sort(permutateables.begin(), permutateables.end(),
+              [](std::shared_ptr<D_Tile> const &lhs, std::shared_ptr<D_Tile> const &rhs)
+              { return lhs->id < rhs->id; });
+    for (auto const &tile : permutateables)
+    {
+        permutate(tile, permutations, entrance_count, exit_count);
+    }
+
+    // Load the permutations to the global map.
     Tile_Map.reserve(Tile_Map.size() + permutations.size());
     Entrance_Map.reserve(Entrance_Map.size() + entrance_count);
     Exit_Map.reserve(Exit_Map.size() + exit_count);
@@ -348,10 +512,8 @@ void D_Tile::generate_tiles()
     err << "Tile Map size:" << Tile_Map.size() << " Permutations size:" << permutations.size() << " Entrance Map size:"
         << Entrance_Map.size() << " Entrance count:" << entrance_count << " Exit Map size:" << Exit_Map.size()
         << " Exit count:" << exit_count << " [Tile]:";
-    for (auto tile : permutations)
+    for (auto const &tile : permutations)
     {
-        //! IMPROVEMENT: vvv (generate_tile_img()) Move image gen out of the loop and use multiple threads for faster processing?
-        tile->generate_tile_img();
         std::pair<uint64_t, std::shared_ptr<D_Tile>> tile_pair = {tile->id, tile};
         auto emplace_pair = Tile_Map.emplace(tile_pair);
         if (!emplace_pair.second)
@@ -379,8 +541,175 @@ void D_Tile::generate_tiles()
             }
         }
 
-        LOG_DEBUG(std::format("{}:{}", "Permutated Tile:", tile->to_string()));
+        LOG_TRACE(std::format("{}:{}", "Permutated Tile:", tile->to_string()));
     }
+
+    Tile_Index = std::make_shared<D_Tile_Index const>(Tile_Map);
+
+    auto const gen_wall = std::chrono::steady_clock::now() - gen_start;
+    LOG_DEBUG(std::format("Generated {} permutations from {} permutable tiles in {}us.",
+                          permutations.size(),
+                          permutateables.size(),
+                          std::chrono::duration_cast<std::chrono::microseconds>(gen_wall).count()));
+
+    if (!manifest_path.empty())
+        save_manifest(manifest_path);
+}
+
+/***********************************************************************************************************************
+ * @brief Loads every tile from a tile manifest written by generate_tiles(), places them in the global maps and rebuilds
+ * the global Tile_Index. The manifest is memory mapped and its records are used directly, no filenames are parsed.
+ *
+ * @param[in] manifest_path Path to the manifest.
+ * @param[in] load_mode Whether images are decoded now or on first use.
+ *
+ * @retval bool True if the tiles were loaded. False if the manifest is missing, from another version, damaged, or
+ * stale, ie the tile directory it was built from has changed since. Callers should fall back on load_tiles() and
+ * generate_tiles() when this returns false.
+ **********************************************************************************************************************/
+bool D_Tile::load_manifest(std::filesystem::path const &manifest_path, Image_Load_Mode load_mode)
+{
+    LOG_DEBUG("Loading tile manifest...");
+    if (!std::filesystem::exists(manifest_path))
+    {
+        LOG_DEBUG("No tile manifest found.");
+        return false;
+    }
+
+    QFile manifest_file(QString::fromStdString(manifest_path.generic_string()));
+    if (!manifest_file.open(QFile::ReadOnly))
+    {
+        LOG_DEBUG("Unable to open tile manifest.");
+        return false;
+    }
+
+    size_t const file_size = static_cast<size_t>(manifest_file.size());
+    unsigned char *mapped = (file_size >= sizeof(Tile_Manifest_Header)) ? manifest_file.map(0, manifest_file.size()) : nullptr;
+    if (!mapped)
+    {
+        LOG_DEBUG("Unable to map tile manifest.");
+        return false;
+    }
+
+    Tile_Manifest_Header header;
+    std::memcpy(&header, mapped, sizeof(header));
+    size_t const records_end = header.records_offset + static_cast<size_t>(header.tile_count) * sizeof(Tile_Manifest_Record);
+    size_t const string_table_end = header.strings_offset + (static_cast<size_t>(header.string_count) + 1) * sizeof(uint32_t);
+    if (TILE_MANIFEST_MAGIC != header.magic ||
+        TILE_MANIFEST_VERSION != header.version ||
+        !header.tile_count ||
+        records_end > file_size ||
+        string_table_end > file_size)
+    {
+        manifest_file.unmap(mapped);
+        LOG_DEBUG("Tile manifest is from another version or damaged.");
+        return false;
+    }
+
+    // Read the interned strings, every offset must land within the string bytes.
+    std::vector<std::string> strings;
+    strings.reserve(header.string_count);
+    size_t const string_bytes = string_table_end;
+    for (uint32_t str = 0; str < header.string_count; str++)
+    {
+        uint32_t bounds[2];
+        std::memcpy(bounds, mapped + header.strings_offset + str * sizeof(uint32_t), sizeof(bounds));
+        if (bounds[0] > bounds[1] || string_bytes + bounds[1] > file_size)
+        {
+            manifest_file.unmap(mapped);
+            LOG_DEBUG("Tile manifest string table is damaged.");
+            return false;
+        }
+        strings.emplace_back(reinterpret_cast<char const *>(mapped + string_bytes + bounds[0]), bounds[1] - bounds[0]);
+    }
+
+    std::vector<Tile_Manifest_Record> records(header.tile_count);
+    std::memcpy(records.data(), mapped + header.records_offset, records.size() * sizeof(Tile_Manifest_Record));
+    manifest_file.unmap(mapped);
+    manifest_file.close();
+
+    for (size_t idx = 0; idx < records.size(); idx++)
+    {
+        Tile_Manifest_Record const &record = records[idx];
+        if (record.name_str >= strings.size() ||
+            record.theme_str >= strings.size() ||
+            record.path_str >= strings.size() ||
+            record.rotation > static_cast<uint8_t>(Connection_Rotations::Two_Seventy) ||
+            (TILE_MANIFEST_NO_BASE != record.base_record && record.base_record >= idx))
+        {
+            LOG_DEBUG("Tile manifest has a damaged tile record.");
+            return false;
+        }
+    }
+
+    // Every base tile's image must still be in the same directory as when the manifest was built.
+    std::filesystem::path tile_dir = std::filesystem::path(strings.at(records.front().path_str)).parent_path();
+    if (stamp_directory(tile_dir) != header.source_stamp)
+    {
+        LOG_DEBUG("Tile manifest is stale.");
+        return false;
+    }
+
+    std::vector<std::shared_ptr<D_Tile>> tiles;
+    tiles.reserve(records.size());
+    uint64_t next_id = 0;
+    for (Tile_Manifest_Record const &record : records)
+    {
+        std::shared_ptr<D_Tile> tile(new D_Tile(strings[record.name_str],
+                                                strings[record.theme_str],
+                                                record.id,
+                                                {.mask = record.connections},
+                                                record.flags & TILE_MANIFEST_ENTRANCE_FLAG,
+                                                record.flags & TILE_MANIFEST_EXIT_FLAG,
+                                                record.flags & TILE_MANIFEST_PERMUTABLE_FLAG,
+                                                record.flags & TILE_MANIFEST_FLIPPABLE_FLAG));
+        tile->path = strings[record.path_str];
+        tile->is_flipped_flag = record.flags & TILE_MANIFEST_FLIPPED_FLAG;
+        tile->rotation_amount = static_cast<Connection_Rotations>(record.rotation);
+        if (TILE_MANIFEST_NO_BASE != record.base_record)
+            tile->base_tile = tiles.at(record.base_record);
+        next_id = std::max(next_id, record.id + 1);
+        tiles.push_back(tile);
+    }
+
+    if (Image_Load_Mode::Eager == load_mode)
+    {
+        run_parallel(tiles.size(), [&](size_t idx)
+                     {
+                         if (!tiles[idx]->base_tile)
+                             tiles[idx]->get_image(); });
+    }
+    else if (Image_Load_Mode::Preview == load_mode)
+    {
+        run_parallel(tiles.size(), [&](size_t idx)
+                     {
+                         if (!tiles[idx]->base_tile)
+                             tiles[idx]->preview_image = tiles[idx]->decode_preview(); });
+    }
+
+    Tile_Map.reserve(Tile_Map.size() + tiles.size());
+    for (auto const &tile : tiles)
+    {
+        std::pair<uint64_t, std::shared_ptr<D_Tile>> tile_pair = {tile->id, tile};
+        if (!Tile_Map.emplace(tile_pair).second)
+            throw std::runtime_error(ERR_FORMAT("Failed placing a tile in the Tile_Map during manifest loading!"));
+        if (tile->is_entrance() && !Entrance_Map.emplace(tile_pair).second)
+            throw std::runtime_error(ERR_FORMAT("Failed placing a tile in the Entrance_Map during manifest loading!"));
+        if (tile->is_exit() && !Exit_Map.emplace(tile_pair).second)
+            throw std::runtime_error(ERR_FORMAT("Failed placing a tile in the Exit_Map during manifest loading!"));
+        if (!tile->get_connections().mask)
+            Empty_Tile = tile;
+    }
+
+    //! NOTE: Keep new ids clear of the ids stored in the manifest.
+    uint64_t current_id = id_counter.load();
+    while (current_id < next_id && !id_counter.compare_exchange_weak(current_id, next_id))
+    {
+    }
+
+    Tile_Index = std::make_shared<D_Tile_Index const>(Tile_Map);
+    LOG_DEBUG(std::format("Loaded {} tiles from the tile manifest.", tiles.size()));
+    return true;
 }
 
 /***********************************************************************************************************************
@@ -424,15 +753,154 @@ D_Connections D_Tile::get_connections() const
 }
 
 /***********************************************************************************************************************
- * @brief Gets the QImage associated with the given tile.
+ * @brief Gets the QImage associated with the given tile. Permutations build their image from their base tile's image
+ * the first time it is requested and keep it, so only permutations that are actually drawn hold pixels of their own.
+ * Tiles loaded with Image_Load_Mode::Lazy decode their image the first time it is requested.
  *
- * @retval std::shared_ptr<QImage> Pointer to the image of the tile from the loaded directory.
+ * @retval std::shared_ptr<QImage> Pointer to the image of the tile.
+ *
+ * @note Safe to call from multiple threads.
  **********************************************************************************************************************/
 std::shared_ptr<QImage> const &D_Tile::get_image()
 {
+    std::call_once(image_flag, [this]()
+                   {
+                       if (base_tile)
+                           set_image(std::make_shared<QImage>(transform_image(*base_tile->get_image())));
+                       else if (!image)
+                           set_image(std::make_shared<QImage>(QString::fromStdString(path.generic_string()))); });
     return image;
 }
 
+/***********************************************************************************************************************
+ * @brief Gets whether every pixel of the tile's image is the same, ie the map can fill it instead of copying it.
+ *
+ * @retval bool True if the image is a single solid pixel value.
+ *
+ * @note False until get_image() has returned, safe to check from any thread meanwhile.
+ **********************************************************************************************************************/
+bool D_Tile::is_solid() const
+{
+    return is_solid_flag.load(std::memory_order_acquire);
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the pixel filling a solid tile's image, in TILE_IMAGE_FORMAT. @see is_solid()
+ *
+ * @retval QRgb The solid pixel, 0 if the image is not solid.
+ *
+ * @warning Only valid once is_solid() has returned true.
+ **********************************************************************************************************************/
+QRgb D_Tile::get_solid_pixel() const
+{
+    return solid_pixel;
+}
+
+/***********************************************************************************************************************
+ * @brief Gets a downsampled copy of the tile's image, level 0 is the image itself and each level after is half the
+ * size of the one before (rounded up) down to 1x1. Levels are built the first time they are requested and kept, so the
+ * cost is paid once per tile however many renders use them. Levels from TILE_PREVIEW_LEVEL on are built from the
+ * tile's preview, so they never need the full image when the tile was loaded with Image_Load_Mode::Preview, and a
+ * permutation builds them from its base tile's preview. @see downsample()
+ *
+ * @param[in] level Level to get, levels past the last return the last, ie the 1x1 image.
+ *
+ * @retval QImage The image at that level, in TILE_IMAGE_FORMAT.
+ *
+ * @note Safe to call from multiple threads.
+ **********************************************************************************************************************/
+QImage const &D_Tile::get_image_level(size_t level)
+{
+    if (!level)
+        return *get_image();
+
+    if (level < TILE_PREVIEW_LEVEL)
+    {
+        QImage const &full = *get_image();
+        std::call_once(levels_flag, [this, &full]()
+                       {
+                           QImage const *previous = &full;
+                           while (image_levels.size() + 1 < TILE_PREVIEW_LEVEL && (previous->width() > 1 || previous->height() > 1))
+                           {
+                               image_levels.push_back(downsample(*previous));
+                               previous = &image_levels.back();
+                           } });
+        return image_levels.empty() ? full : image_levels[std::min(level, image_levels.size()) - 1];
+    }
+
+    std::call_once(preview_flag, [this]()
+                   {
+                       if (!preview_image.isNull())
+                           preview_levels.push_back(preview_image);
+                       else if (base_tile)
+                           preview_levels.push_back(transform_image(base_tile->get_image_level(TILE_PREVIEW_LEVEL)));
+                       else
+                           preview_levels.push_back(downsample(get_image_level(TILE_PREVIEW_LEVEL - 1)));
+                       while (preview_levels.back().width() > 1 || preview_levels.back().height() > 1)
+                           preview_levels.push_back(downsample(preview_levels.back())); });
+    return preview_levels[std::min(level - TILE_PREVIEW_LEVEL, preview_levels.size() - 1)];
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the number of levels the tile's image has, including the image itself, ie up to the first 1x1 level.
+ * @see get_image_level()
+ *
+ * @retval size_t Level count, at least 1.
+ *
+ * @note Only decodes the full image when the preview is already 1x1.
+ **********************************************************************************************************************/
+size_t D_Tile::get_level_count()
+{
+    QImage const &preview = get_image_level(TILE_PREVIEW_LEVEL);
+    if (preview.width() > 1 || preview.height() > 1)
+        return TILE_PREVIEW_LEVEL + preview_levels.size();
+
+    size_t count = 1;
+    for (QImage const *level = &get_image_level(0); count <= TILE_PREVIEW_LEVEL && (level->width() > 1 || level->height() > 1);)
+        level = &get_image_level(count++);
+    return count;
+}
+
+/***********************************************************************************************************************
+ * @brief Halves an image in both dimensions (rounded up) with a 2x2 box filter, an odd last row or column is averaged
+ * with itself. Two 8 bit channels are summed per 32 bit lane (red and blue, then alpha and green) so each pixel takes
+ * two masked adds rather than four, and the inner loop has no branches so the compiler can vectorise it.
+ *
+ * @param[in] image Image to downsample, in TILE_IMAGE_FORMAT.
+ *
+ * @retval QImage The downsampled image, null if the given image is.
+ *
+ * @note Channels are averaged without premultiplying, matching how tiles are copied into the map as is.
+ **********************************************************************************************************************/
+QImage D_Tile::downsample(QImage const &image)
+{
+    if (image.isNull())
+        return QImage();
+
+    int const width = (image.width() + 1) / 2;
+    int const height = (image.height() + 1) / 2;
+    QImage half(width, height, TILE_IMAGE_FORMAT);
+    for (int y = 0; y < height; y++)
+    {
+        QRgb const *top = reinterpret_cast<QRgb const *>(image.constScanLine(2 * y));
+        QRgb const *bottom = reinterpret_cast<QRgb const *>(image.constScanLine(std::min(2 * y + 1, image.height() - 1)));
+        QRgb *out = reinterpret_cast<QRgb *>(half.bits() + y * half.bytesPerLine());
+        for (int x = 0; x < width; x++)
+        {
+            int const left = 2 * x;
+            int const right = std::min(left + 1, image.width() - 1);
+            // Each lane sums at most 4 * 255 + 2, so no carry reaches the next channel.
+            uint32_t const red_blue = (top[left] & 0x00FF00FFu) + (top[right] & 0x00FF00FFu) +
+                                      (bottom[left] & 0x00FF00FFu) + (bottom[right] & 0x00FF00FFu) + 0x00020002u;
+            uint32_t const alpha_green = ((top[left] >> 8) & 0x00FF00FFu) + ((top[right] >> 8) & 0x00FF00FFu) +
+                                         ((bottom[left] >> 8) & 0x00FF00FFu) + ((bottom[right] >> 8) & 0x00FF00FFu) +
+                                         0x00020002u;
+            out[x] = ((red_blue >> 2) & 0x00FF00FFu) | (((alpha_green >> 2) & 0x00FF00FFu) << 8);
+        }
+    }
+    return half;
+}
+
 /***********************************************************************************************************************
  * @brief Gets the permutable flag of the tile.
  *
@@ -548,6 +1016,92 @@ std::string const D_Tile::connections_to_string() const
 ========================================================================================================================
 */
 
+/***********************************************************************************************************************
+ * @brief Private constructor to build a D_Tile from an image path with an already reserved id, used when tiles are
+ * parsed in parallel so that ids do not depend on thread scheduling.
+ *
+ * @param[in] in_path Path to the image file, @see D_Tile(std::filesystem::path const &) for its filename format.
+ * @param[in] in_id Id to give the tile.
+ *
+ * @throws std::invalid_argument if in_path filename is empty, if name member ends up empty, if theme member ends up
+ * empty, or if it is labeled as both an entrance and an exit.
+ **********************************************************************************************************************/
+D_Tile::D_Tile(std::filesystem::path const &in_path, uint64_t in_id)
+{
+    if (in_path.filename().generic_string().empty())
+        throw std::invalid_argument(ERR_FORMAT("Empty filename in path given to D_Tile()!"));
+
+    std::vector<std::string> file_tokens;
+    std::string file_token;
+    std::vector<std::string> connection_tokens;
+    std::string connection_token;
+    std::stringstream file_str_stream(in_path.filename().generic_string());
+    char const semi_colon = ';';
+    char const comma = ',';
+
+    file_tokens.reserve(FILE_NAME_TOKEN_NUM);
+    connection_tokens.reserve(TILE_CONNECTION_MAX);
+
+    // Parse info
+    while (std::getline(file_str_stream, file_token, semi_colon))
+    {
+        file_tokens.push_back(file_token);
+    }
+
+    std::stringstream connection_string_stream(file_tokens.at(TILE_CON_IDX));
+    while (std::getline(connection_string_stream, connection_token, comma))
+    {
+        connection_tokens.push_back(connection_token);
+    }
+
+    // Remove '.jpg'
+    [[maybe_unused]] std::stringstream err;
+    size_t idx = file_tokens.at(TILE_FLIP_FLG_IDX).find_first_of('.');
+    if (idx == std::string::npos)
+    {
+        err << "No file type in file path!";
+        err << to_string();
+        throw std::invalid_argument(ERR_FORMAT(err.str()));
+    }
+    file_tokens.at(TILE_FLIP_FLG_IDX) = file_tokens.at(TILE_FLIP_FLG_IDX).erase(idx);
+
+    // Set members
+    path = in_path;
+    name = file_tokens.at(TILE_NAME_IDX);
+    theme = file_tokens.at(TILE_THEME_IDX);
+    id = in_id;
+    map_connection_tokens(connection_tokens);
+    is_entrance_flag = file_tokens.at(TILE_ENT_FLG_IDX).compare("true") ? false : true;
+    is_exit_flag = file_tokens.at(TILE_EXT_FLG_IDX).compare("true") ? false : true;
+    is_permutateable_flag = file_tokens.at(TILE_PERM_FLG_IDX).compare("true") ? false : true;
+    is_flippable_flag = file_tokens.at(TILE_FLIP_FLG_IDX).compare("true") ? false : true;
+
+    if (name.empty())
+    {
+        err << "Tile name found to be empty at end of D_Tile()!:";
+        err << to_string();
+        throw std::invalid_argument(ERR_FORMAT(err.str()));
+    }
+    if (theme.empty())
+    {
+        err << "Tile theme found to be empty at end of D_Tile!:";
+        err << to_string();
+        throw std::invalid_argument(ERR_FORMAT(err.str()));
+    }
+    if (is_entrance() && is_exit())
+    {
+        err << "A tile cannot be both an entrance and an exit!:";
+        err << to_string();
+        throw std::invalid_argument(ERR_FORMAT(err.str()));
+    }
+    if (is_flippable() && !is_permutateable())
+    {
+        err << "A tile cannot be flippable and not be permutateable!:";
+        err << to_string();
+        throw std::invalid_argument(ERR_FORMAT(err.str()));
+    }
+}
+
 /***********************************************************************************************************************
  * @brief Private constructor to build new D_Tile objects from permutaion values.
  *
@@ -654,9 +1208,7 @@ inline void D_Tile::permutate(std::shared_ptr<D_Tile> permutateable,
         permutation_limiter = ROTATION_ARR.size() - 2;
     }
 
-    std::stringstream ss;
-    ss << "Permutating Tile:" << permutateable->to_string();
-    LOG_DEBUG(ss.str());
+    LOG_TRACE(std::format("Permutating Tile:{}", permutateable->to_string()));
 
     if (permutateable->is_flippable())
     {
@@ -691,9 +1243,8 @@ inline void D_Tile::permutate(std::shared_ptr<D_Tile> permutateable,
             ));
 
         tile->rotation_amount = ROTATION_ARR[idx];
-        std::string filename = tile->to_filename();
-        tile->path = std::filesystem::path(std::format("{}/{}", permutateable->path.parent_path().generic_string(), filename));
-        tile->image = std::make_shared<QImage>(*permutateable->image);
+        tile->path = permutateable->path;
+        tile->base_tile = permutateable;
         permutations.push_back(tile);
     }
 
@@ -714,11 +1265,8 @@ inline void D_Tile::permutate(std::shared_ptr<D_Tile> permutateable,
             ));
 
         flipped->is_flipped_flag = true;
-        std::string flipped_filename = flipped->to_filename();
-        flipped->path = std::filesystem::path(std::format("{}/{}",
-                                                          permutateable->path.parent_path().generic_string(),
-                                                          flipped_filename));
-        flipped->image = std::make_shared<QImage>(*permutateable->image);
+        flipped->path = permutateable->path;
+        flipped->base_tile = permutateable;
         permutations.push_back(flipped);
 
         // And rotate
@@ -738,72 +1286,31 @@ inline void D_Tile::permutate(std::shared_ptr<D_Tile> permutateable,
 
             tile->is_flipped_flag = true;
             tile->rotation_amount = ROTATION_ARR[idx];
-            std::string filename = tile->to_filename();
-            tile->path = std::filesystem::path(std::format("{}/{}", permutateable->path.parent_path().generic_string(), filename));
-            tile->image = std::make_shared<QImage>(*permutateable->image);
+            tile->path = permutateable->path;
+            tile->base_tile = permutateable;
             permutations.push_back(tile);
         }
     }
 }
 
 /***********************************************************************************************************************
- * @brief Outputs a string to name a new generated tile.
+ * @brief Applies this tile's flip and rotation to its base tile's image.
  *
- * @note This image filename is in the following format:
- * name;theme;connections,with,comma,separated,values;is_entrance;is_exit;is_permutateable;is_flippable
- * For example:
- * 3WayInter0;fort;T3,T4,R3,R4,B3,B4;false;false;true;false
- **********************************************************************************************************************/
-inline std::string const D_Tile::to_filename()
-{
-    std::stringstream ss;
-    ss << name << ";" << theme << ";";
-
-    // Build a vector of connection tokens to properly place commas or the ending semicolon.
-    std::vector<std::string> connection_tokens;
-    connection_tokens.reserve(32);
-    for (auto itr = Connection_Bit_Mask_to_Str_Map.begin(); itr != Connection_Bit_Mask_to_Str_Map.end(); itr++)
-    {
-        if (itr->first & connections.mask)
-            connection_tokens.push_back(itr->second);
-    }
-
-    // Stream in the connections.
-    for (size_t idx = 0; idx < connection_tokens.size(); idx++)
-    {
-        if (idx == connection_tokens.size() - 1) // Dont add a comma at the last connection, place a semicolon instead.
-            ss << connection_tokens.at(idx) << ';';
-        else
-            ss << connection_tokens.at(idx) << ',';
-    }
-
-    // Stream the remaining attributes.
-    is_entrance() ? ss << "true;" : ss << "false;";
-    is_exit() ? ss << "true;" : ss << "false;";
-    is_permutateable() ? ss << "true;" : ss << "false;";
-    is_flippable() ? ss << "true" : ss << "false"; // Last part of the filename has no semicolon.
-
-    ss << ".jpg";
-
-    return ss.str();
-}
-
-/***********************************************************************************************************************
- * @brief Creates an image for a D_Tile and saves it at the instances's path member.
+ * @param[in] base_image Image of the base tile this permutation was made from.
  *
- * @retval bool Whether or not the image was successfuly created.
+ * @retval QImage The permutation's image.
+ *
+ * @throws std::invalid_argument if the base image is null.
  **********************************************************************************************************************/
-bool D_Tile::generate_tile_img()
+QImage D_Tile::transform_image(QImage const &base_image) const
 {
-    if (!image || image->isNull())
-        throw std::invalid_argument(ERR_FORMAT("Null image reference found when generating a tile image!"));
+    if (base_image.isNull())
+        throw std::invalid_argument(ERR_FORMAT("Null image reference found when transforming a tile image!"));
 
+    QImage out = is_flipped() ? base_image.flipped(Qt::Horizontal) : base_image;
     QTransform matrix;
     double degrees = 0.0;
 
-    if (is_flipped())
-        image->flip(Qt::Horizontal);
-
     switch (rotation_amount)
     {
     case Connection_Rotations::Nintey:
@@ -825,10 +1332,71 @@ bool D_Tile::generate_tile_img()
     if (0 < degrees)
     {
         matrix.rotate(degrees);
-        *image = image->transformed(matrix);
+        out = out.transformed(matrix);
     }
 
-    return image->save(QString::fromStdString(path.generic_string()), "JPG", DEFAULT_OUTPUT_QUALITY);
+    return out;
+}
+
+/***********************************************************************************************************************
+ * @brief Sets the tile's image, converting it to TILE_IMAGE_FORMAT once here rather than on every draw, and checks if
+ * it is a single solid pixel value.
+ *
+ * @param[in] in_image Image to use for the tile.
+ **********************************************************************************************************************/
+void D_Tile::set_image(std::shared_ptr<QImage> in_image)
+{
+    if (!in_image->isNull() && TILE_IMAGE_FORMAT != in_image->format())
+        in_image->convertTo(TILE_IMAGE_FORMAT);
+
+    bool solid = false;
+    QRgb first = 0;
+    if (!in_image->isNull() && in_image->width() && in_image->height())
+    {
+        first = reinterpret_cast<QRgb const *>(in_image->constScanLine(0))[0];
+        solid = true;
+        for (int y = 0; y < in_image->height() && solid; y++)
+        {
+            QRgb const *line = reinterpret_cast<QRgb const *>(in_image->constScanLine(y));
+            solid = std::all_of(line, line + in_image->width(), [first](QRgb pixel)
+                                { return pixel == first; });
+        }
+    }
+    //! NOTE: The pixel is stored before the flag, a reader that sees the flag set also sees the pixel.
+    solid_pixel = solid ? first : 0;
+    is_solid_flag.store(solid, std::memory_order_release);
+    image = std::move(in_image);
+}
+
+/***********************************************************************************************************************
+ * @brief Decodes the tile's image straight at preview size, ie TILE_PREVIEW_LEVEL, with QImageReader::setScaledSize so
+ * JPEG tiles are scaled while decoding instead of after.
+ *
+ * @retval QImage The preview in TILE_IMAGE_FORMAT, the same size as get_image_level(TILE_PREVIEW_LEVEL) would build.
+ * Null if the image could not be read.
+ *
+ * @note The reader's scaling filter is not the box filter of downsample(), previews may differ slightly in pixels.
+ **********************************************************************************************************************/
+QImage D_Tile::decode_preview() const
+{
+    QImageReader reader(QString::fromStdString(path.generic_string()));
+    QSize full_size = reader.size();
+    if (full_size.isValid())
+    {
+        int width = full_size.width();
+        int height = full_size.height();
+        for (size_t level = 0; level < TILE_PREVIEW_LEVEL; level++)
+        {
+            width = (width + 1) / 2;
+            height = (height + 1) / 2;
+        }
+        reader.setScaledSize(QSize(width, height));
+    }
+
+    QImage preview = reader.read();
+    if (!preview.isNull() && TILE_IMAGE_FORMAT != preview.format())
+        preview.convertTo(TILE_IMAGE_FORMAT);
+    return preview;
 }
 
 /***********************************************************************************************************************
@@ -856,6 +1424,167 @@ void D_Tile::copy_tile_img(std::filesystem::path loaded_dir)
     path = new_path;
 }
 
+/***********************************************************************************************************************
+ * @brief Writes every tile in the global Tile_Map to a tile manifest. @see load_manifest()
+ *
+ * @param[in] manifest_path Path to write the manifest to, it is written to a temporary file and then renamed over any
+ * previous manifest.
+ *
+ * @throws std::runtime_error if the Tile_Map is empty, if base tiles come from more than one directory, or if the
+ * manifest cannot be written.
+ **********************************************************************************************************************/
+void D_Tile::save_manifest(std::filesystem::path const &manifest_path)
+{
+    if (Tile_Map.empty())
+        throw std::runtime_error(ERR_FORMAT("Cannot write a tile manifest for an empty Tile_Map!"));
+
+    std::vector<std::shared_ptr<D_Tile>> tiles;
+    tiles.reserve(Tile_Map.size());
+    for (auto const &pair : Tile_Map)
+        tiles.push_back(pair.second);
+    std::sort(tiles.begin(), tiles.end(), [](std::shared_ptr<D_Tile> const &lhs, std::shared_ptr<D_Tile> const &rhs)
+              { return lhs->id < rhs->id; });
+
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> string_ids;
+    auto intern = [&](std::string const &str) -> uint32_t
+    {
+        auto emplace_pair = string_ids.emplace(str, static_cast<uint32_t>(strings.size()));
+        if (emplace_pair.second)
+            strings.push_back(str);
+        return emplace_pair.first->second;
+    };
+
+    std::unordered_map<uint64_t, uint32_t> record_ids;
+    std::vector<Tile_Manifest_Record> records;
+    records.reserve(tiles.size());
+    std::filesystem::path const tile_dir = tiles.front()->path.parent_path();
+    for (auto const &tile : tiles)
+    {
+        if (tile->path.parent_path() != tile_dir)
+            throw std::runtime_error(ERR_FORMAT("Tile manifests require every tile image to be in one directory!"));
+
+        Tile_Manifest_Record record = {};
+        record.id = tile->id;
+        record.connections = tile->connections.mask;
+        record.name_str = intern(tile->name);
+        record.theme_str = intern(tile->theme);
+        record.path_str = intern(tile->path.generic_string());
+        //! NOTE: Base tiles always have lower ids than their permutations so they are already recorded.
+        record.base_record = tile->base_tile ? record_ids.at(tile->base_tile->id) : TILE_MANIFEST_NO_BASE;
+        record.flags = static_cast<uint8_t>((tile->is_entrance() ? TILE_MANIFEST_ENTRANCE_FLAG : 0U) |
+                                            (tile->is_exit() ? TILE_MANIFEST_EXIT_FLAG : 0U) |
+                                            (tile->is_permutateable() ? TILE_MANIFEST_PERMUTABLE_FLAG : 0U) |
+                                            (tile->is_flippable() ? TILE_MANIFEST_FLIPPABLE_FLAG : 0U) |
+                                            (tile->is_flipped() ? TILE_MANIFEST_FLIPPED_FLAG : 0U));
+        record.rotation = static_cast<uint8_t>(tile->rotation_amount);
+        record_ids.emplace(tile->id, static_cast<uint32_t>(records.size()));
+        records.push_back(record);
+    }
+
+    std::vector<uint32_t> string_offsets;
+    string_offsets.reserve(strings.size() + 1);
+    uint32_t string_offset = 0;
+    for (auto const &str : strings)
+    {
+        string_offsets.push_back(string_offset);
+        string_offset += static_cast<uint32_t>(str.size());
+    }
+    string_offsets.push_back(string_offset);
+
+    Tile_Manifest_Header header = {};
+    header.magic = TILE_MANIFEST_MAGIC;
+    header.version = TILE_MANIFEST_VERSION;
+    header.source_stamp = stamp_directory(tile_dir);
+    header.tile_count = static_cast<uint32_t>(records.size());
+    header.string_count = static_cast<uint32_t>(strings.size());
+    header.records_offset = sizeof(Tile_Manifest_Header);
+    header.strings_offset = header.records_offset + records.size() * sizeof(Tile_Manifest_Record);
+
+    std::filesystem::path tmp_path = manifest_path;
+    tmp_path += ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        out.write(reinterpret_cast<char const *>(records.data()),
+                  static_cast<std::streamsize>(records.size() * sizeof(Tile_Manifest_Record)));
+        out.write(reinterpret_cast<char const *>(string_offsets.data()),
+                  static_cast<std::streamsize>(string_offsets.size() * sizeof(uint32_t)));
+        for (auto const &str : strings)
+            out.write(str.data(), static_cast<std::streamsize>(str.size()));
+        if (!out)
+            throw std::runtime_error(ERR_FORMAT(std::format("Failed writing tile manifest to {}!", tmp_path.generic_string())));
+    }
+    std::filesystem::rename(tmp_path, manifest_path);
+
+    LOG_DEBUG(std::format("Wrote {} tiles to the tile manifest at {}.", records.size(), manifest_path.generic_string()));
+}
+
+/***********************************************************************************************************************
+ * @brief Stamps a tile directory from the name, size and last write time of every file in it, used to tell when a tile
+ * manifest is stale.
+ *
+ * @param[in] dir_path Directory to stamp.
+ *
+ * @retval uint64_t Stamp of the directory, zero if the directory does not exist.
+ **********************************************************************************************************************/
+uint64_t D_Tile::stamp_directory(std::filesystem::path const &dir_path)
+{
+    std::error_code ec;
+    if (!std::filesystem::is_directory(dir_path, ec))
+        return 0;
+
+    std::vector<std::filesystem::path> file_paths;
+    for (std::filesystem::directory_entry const &dir_entry : std::filesystem::directory_iterator{dir_path})
+    {
+        if (dir_entry.is_directory())
+            continue;
+        file_paths.push_back(dir_entry.path());
+    }
+    std::sort(file_paths.begin(), file_paths.end());
+
+    uint64_t stamp = FNV1A_64_OFFSET_BASIS;
+    for (auto const &file_path : file_paths)
+    {
+        std::string const filename = file_path.filename().generic_string();
+        uint64_t const file_size = static_cast<uint64_t>(std::filesystem::file_size(file_path));
+        int64_t const write_time = static_cast<int64_t>(std::filesystem::last_write_time(file_path).time_since_epoch().count());
+        stamp = fnv1a_64(filename.data(), filename.size(), stamp);
+        stamp = fnv1a_64(&file_size, sizeof(file_size), stamp);
+        stamp = fnv1a_64(&write_time, sizeof(write_time), stamp);
+    }
+
+    return stamp;
+}
+
+/***********************************************************************************************************************
+ * @brief Hashes a tile image file by its filename, which holds the tile's metadata, and its content.
+ *
+ * @param[in] file_path Path to the tile image.
+ *
+ * @retval uint64_t FNV-1a hash of the filename and content.
+ *
+ * @throws std::runtime_error if the file cannot be read.
+ **********************************************************************************************************************/
+uint64_t D_Tile::hash_tile_file(std::filesystem::path const &file_path)
+{
+    std::string const filename = file_path.filename().generic_string();
+    uint64_t hash = fnv1a_64(filename.data(), filename.size());
+
+    std::ifstream in(file_path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error(ERR_FORMAT(std::format("Unable to read tile image {}!", file_path.generic_string())));
+
+    std::vector<char> buffer(1 << 16);
+    while (in)
+    {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash = fnv1a_64(buffer.data(), static_cast<size_t>(in.gcount()), hash);
+    }
+
+    return hash;
+}
+
 /***********************************************************************************************************************
  * @brief Rotates connections for a given connection bitmap according to a rotation enum value.
  *
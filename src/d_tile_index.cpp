@@ -0,0 +1,406 @@
+/***********************************************************************************************************************
+ * @date 2026-10-16
+ * @author Gregory Nitch
+ *
+ * @brief D_Tile_Index implementation functions. This class indexes tiles by their connections so that map generation
+ * can select canidates with a handful of word operations rather than a scan of every tile.
+ **********************************************************************************************************************/
+
+/*
+========================================================================================================================
+- - System Includes - -
+========================================================================================================================
+*/
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <format>
+
+/*
+========================================================================================================================
+- - Local Includes - -
+========================================================================================================================
+*/
+
+#include "d_tile_index.hpp"
+#include "d_builder_common.hpp"
+
+/*
+========================================================================================================================
+- - Class Methods - -
+========================================================================================================================
+*/
+
+/***********************************************************************************************************************
+ * @brief Constructor for a D_Tile_Index, slots every tile in the given map by id and builds the connection bitsets.
+ *
+ * @param[in] tile_map Map of tiles to index.
+ *
+ * @throws std::invalid_argument if the map is empty or contains a nullptr.
+ **********************************************************************************************************************/
+D_Tile_Index::D_Tile_Index(std::unordered_map<uint64_t, std::shared_ptr<D_Tile>> const &tile_map)
+{
+    if (tile_map.empty())
+        throw std::invalid_argument(ERR_FORMAT("Given an empty tile map to index!"));
+
+    owners.reserve(tile_map.size());
+    for (auto const &tile_pair : tile_map)
+    {
+        if (nullptr == tile_pair.second)
+            throw std::invalid_argument(ERR_FORMAT("Found nullptr in tile map while building index!"));
+        owners.push_back(tile_pair.second);
+    }
+
+    //! NOTE: Slots are ordered by id so that the same tile set always produces the same index.
+    std::sort(owners.begin(), owners.end(), [](std::shared_ptr<D_Tile> const &lhs, std::shared_ptr<D_Tile> const &rhs)
+              { return lhs->get_id() < rhs->get_id(); });
+    slots.reserve(owners.size());
+    for (std::shared_ptr<D_Tile> const &owner : owners)
+        slots.push_back(owner.get());
+
+    slot_connections.reserve(slots.size());
+    slot_facing_connections.reserve(slots.size());
+    hash = FNV1A_64_OFFSET_BASIS;
+    for (auto const &tile : slots)
+    {
+        // Everything that decides what a slot's tile looks like or connects to.
+        uint64_t const id = tile->get_id();
+        uint32_t const mask = tile->get_connections().mask;
+        uint8_t const orientation = static_cast<uint8_t>(static_cast<uint8_t>(tile->get_rotation_amount()) |
+                                                         (tile->is_flipped() ? 0x80 : 0));
+        hash = fnv1a_64(&id, sizeof(id), hash);
+        hash = fnv1a_64(&mask, sizeof(mask), hash);
+        hash = fnv1a_64(&orientation, sizeof(orientation), hash);
+        hash = fnv1a_64(tile->get_name().data(), tile->get_name().size(), hash);
+        hash = fnv1a_64(tile->get_theme().data(), tile->get_theme().size(), hash);
+
+        D_Connections connections = tile->get_connections();
+        D_Connections facing = connections;
+        for (uint8_t &side : facing.sides)
+            side = reverse_8bits(side);
+        slot_connections.push_back(connections);
+        slot_facing_connections.push_back(facing);
+    }
+
+    word_count = (slots.size() + TILE_INDEX_WORD_BITS - 1) / TILE_INDEX_WORD_BITS;
+    connection_words.assign(word_count * TILE_INDEX_CONNECTION_BITS, 0);
+    all_words.assign(word_count, 0);
+    entrance_words.assign(word_count, 0);
+
+    for (size_t slot = 0; slot < slots.size(); slot++)
+    {
+        size_t word = slot / TILE_INDEX_WORD_BITS;
+        uint64_t slot_bit = 1ULL << (slot % TILE_INDEX_WORD_BITS);
+        uint32_t mask = slot_connections[slot].mask;
+
+        all_words[word] |= slot_bit;
+        if (slots[slot]->is_entrance())
+            entrance_words[word] |= slot_bit;
+
+        while (mask)
+        {
+            int bit = std::countr_zero(mask);
+            connection_words[word * TILE_INDEX_CONNECTION_BITS + static_cast<size_t>(bit)] |= slot_bit;
+            mask &= mask - 1;
+        }
+    }
+
+    //! NOTE: The empty slot has no connections, so it sits in the zero pattern of every side.
+    domain_word_count = (slots.size() + 1 + TILE_INDEX_WORD_BITS - 1) / TILE_INDEX_WORD_BITS;
+    size_t const empty_slot = slots.size();
+    for (size_t side = 0; side < side_patterns.size(); side++)
+    {
+        side_pattern_lookup[side].fill(TILE_INDEX_NO_PATTERN);
+        for (size_t slot = 0; slot <= empty_slot; slot++)
+        {
+            uint8_t pattern = (slot == empty_slot) ? CONNECTION_ZERO_MASK : slot_connections[slot].sides[side];
+            if (TILE_INDEX_NO_PATTERN == side_pattern_lookup[side][pattern])
+            {
+                side_pattern_lookup[side][pattern] = static_cast<uint16_t>(side_patterns[side].size());
+                side_patterns[side].push_back(pattern);
+                side_pattern_words[side].resize(side_patterns[side].size() * domain_word_count, 0);
+            }
+            size_t pattern_word = side_pattern_lookup[side][pattern] * domain_word_count + slot / TILE_INDEX_WORD_BITS;
+            side_pattern_words[side][pattern_word] |= 1ULL << (slot % TILE_INDEX_WORD_BITS);
+        }
+    }
+
+    //! NOTE: The catalog is fixed once indexed, so which neighboors each slot accepts is resolved here once.
+    compatible_patterns.resize(empty_slot + 1);
+    no_domain_words.assign(domain_word_count, 0);
+    for (size_t slot = 0; slot <= empty_slot; slot++)
+    {
+        for (size_t side = 0; side < side_patterns.size(); side++)
+        {
+            uint8_t pattern = (slot == empty_slot) ? CONNECTION_ZERO_MASK : slot_connections[slot].sides[side];
+            size_t const mirror = (side + 2) & NEXT_SIDE_IDX_BIT_MASK;
+            compatible_patterns[slot][side] = side_pattern_lookup[mirror][reverse_8bits(pattern)];
+        }
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the number of tiles in the index.
+ *
+ * @retval size_t Number of indexed tiles.
+ **********************************************************************************************************************/
+size_t D_Tile_Index::size() const
+{
+    return slots.size();
+}
+
+/***********************************************************************************************************************
+ * @brief Gets a hash of the indexed tile set, ie every slot's tile id, connections, orientation, name and theme in slot
+ * order. Two indexes with the same hash give the same meaning to every slot, so saved tile handles can be reused.
+ *
+ * @retval uint64_t FNV-1a hash of the tile set.
+ **********************************************************************************************************************/
+uint64_t D_Tile_Index::get_hash() const
+{
+    return hash;
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the number of words a canidate bitset for this index needs.
+ *
+ * @retval size_t Number of uint64_t words per canidate bitset.
+ **********************************************************************************************************************/
+size_t D_Tile_Index::get_word_count() const
+{
+    return word_count;
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the tile at the given slot.
+ *
+ * @param[in] slot Slot of the tile in the index.
+ *
+ * @retval D_Tile* The tile held at that slot, it lives as long as the index.
+ **********************************************************************************************************************/
+D_Tile *D_Tile_Index::get_tile(size_t slot) const
+{
+    return slots.at(slot);
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the connections of the tile at the given slot.
+ *
+ * @param[in] slot Slot of the tile in the index.
+ *
+ * @retval D_Connections Connections of the tile held at that slot.
+ *
+ * @warning The slot is not bounds checked.
+ **********************************************************************************************************************/
+D_Connections D_Tile_Index::get_connections(size_t slot) const
+{
+    return slot_connections[slot];
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the connections of the tile at the given slot with each side reversed, ie as the neighboor facing a side
+ * sees it.
+ *
+ * @param[in] slot Slot of the tile in the index.
+ *
+ * @retval D_Connections Mirrored connections of the tile held at that slot.
+ *
+ * @warning The slot is not bounds checked.
+ **********************************************************************************************************************/
+D_Connections D_Tile_Index::get_facing_connections(size_t slot) const
+{
+    return slot_facing_connections[slot];
+}
+
+/***********************************************************************************************************************
+ * @brief Finds the slot of the tile with the given id.
+ *
+ * @param[in] id Id of the tile to find.
+ *
+ * @retval size_t Slot of the tile.
+ *
+ * @throws std::out_of_range if no tile in the index has the given id.
+ **********************************************************************************************************************/
+size_t D_Tile_Index::find_slot(uint64_t id) const
+{
+    auto found = std::lower_bound(slots.begin(), slots.end(), id, [](D_Tile const *tile, uint64_t value)
+                                  { return tile->get_id() < value; });
+    if (found == slots.end() || (*found)->get_id() != id)
+        throw std::out_of_range(ERR_FORMAT(std::format("Tile id {} is not in the tile index!", id)));
+
+    return static_cast<size_t>(found - slots.begin());
+}
+
+/***********************************************************************************************************************
+ * @brief Fills a canidate bitset with every tile in the given set that meets the given connection requirements.
+ *
+ * @param[in] tile_set The base set of tiles to filter from.
+ * @param[in] required_mask Connections that a canidate must have.
+ * @param[in] allowed_mask Connections that a canidate may have, any connection outside of this mask excludes the tile.
+ * @param[in] side_requirements Sides that a canidate must connect on, a canidate must share at least one bit with each
+ * non zero side in this mask.
+ * @param[out] canidate_words Bitset to fill with the canidate slots, resized to the index word count.
+ *
+ * @retval size_t Number of canidates found.
+ **********************************************************************************************************************/
+size_t D_Tile_Index::filter(D_Tile_Set tile_set,
+                            uint32_t required_mask,
+                            uint32_t allowed_mask,
+                            D_Connections side_requirements,
+                            std::vector<uint64_t> &canidate_words) const
+{
+    std::vector<uint64_t> const &base_words = (D_Tile_Set::Entrances == tile_set) ? entrance_words : all_words;
+    uint32_t const excluded_mask = ~allowed_mask & ~required_mask;
+    size_t count = 0;
+
+    canidate_words.resize(word_count);
+    for (size_t word = 0; word < word_count; word++)
+    {
+        uint64_t canidates = base_words[word];
+        uint64_t const *bit_words = &connection_words[word * TILE_INDEX_CONNECTION_BITS];
+
+        for (uint32_t mask = required_mask; mask && canidates; mask &= mask - 1)
+            canidates &= bit_words[std::countr_zero(mask)];
+
+        for (uint32_t mask = excluded_mask; mask && canidates; mask &= mask - 1)
+            canidates &= ~bit_words[std::countr_zero(mask)];
+
+        for (size_t side = 0; side < CONNECTION_SIDE_MASKS.size() && canidates; side++)
+        {
+            uint32_t side_mask = side_requirements.mask & CONNECTION_SIDE_MASKS[side];
+            if (!side_mask)
+                continue;
+
+            uint64_t side_canidates = 0;
+            for (; side_mask; side_mask &= side_mask - 1)
+                side_canidates |= bit_words[std::countr_zero(side_mask)];
+            canidates &= side_canidates;
+        }
+
+        canidate_words[word] = canidates;
+        count += static_cast<size_t>(std::popcount(canidates));
+    }
+
+    return count;
+}
+
+/***********************************************************************************************************************
+ * @brief Finds the slot of the nth set canidate in a canidate bitset.
+ *
+ * @param[in] canidate_words Bitset filled by filter().
+ * @param[in] n Zero based position of the canidate to find.
+ *
+ * @retval size_t Slot of the canidate.
+ *
+ * @throws std::out_of_range if there are not more than n canidates in the bitset.
+ **********************************************************************************************************************/
+size_t D_Tile_Index::nth_canidate(std::vector<uint64_t> const &canidate_words, size_t n) const
+{
+    for (size_t word = 0; word < canidate_words.size(); word++)
+    {
+        uint64_t canidates = canidate_words[word];
+        size_t word_count_set = static_cast<size_t>(std::popcount(canidates));
+        if (n >= word_count_set)
+        {
+            n -= word_count_set;
+            continue;
+        }
+
+        for (; n; n--)
+            canidates &= canidates - 1;
+        return word * TILE_INDEX_WORD_BITS + static_cast<size_t>(std::countr_zero(canidates));
+    }
+
+    throw std::out_of_range(ERR_FORMAT("Requested canidate is outside of the canidate bitset!"));
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the virtual slot that stands for the Empty_Tile in domain bitsets, it is never a slot of get_tile().
+ *
+ * @retval size_t The empty slot, ie one past the last tile slot.
+ **********************************************************************************************************************/
+size_t D_Tile_Index::get_empty_slot() const
+{
+    return slots.size();
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the number of words a domain bitset for this index needs, ie every tile slot plus the empty slot.
+ *
+ * @retval size_t Number of uint64_t words per domain bitset.
+ **********************************************************************************************************************/
+size_t D_Tile_Index::get_domain_word_count() const
+{
+    return domain_word_count;
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the domain bitset of every slot with exactly the given pattern on a side.
+ *
+ * @param[in] side Side index of the pattern, @see D_Connections::sides.
+ * @param[in] pattern Side mask to match.
+ *
+ * @retval uint64_t const * Domain bitset of get_domain_word_count() words, nullptr if no slot has the pattern.
+ **********************************************************************************************************************/
+uint64_t const *D_Tile_Index::side_pattern_domain(size_t side, uint8_t pattern) const
+{
+    uint16_t pattern_idx = side_pattern_lookup[side][pattern];
+    if (TILE_INDEX_NO_PATTERN == pattern_idx)
+        return nullptr;
+    return &side_pattern_words[side][pattern_idx * domain_word_count];
+}
+
+/***********************************************************************************************************************
+ * @brief Fills a domain bitset with every slot that can sit next to a neighboor, ie whose side facing the neighboor
+ * mirrors the facing side of at least one slot in the neighboor's domain.
+ *
+ * @param[in] side Side index of the neighboor, ie 0 when the neighboor is above.
+ * @param[in] neighboor_domain Domain bitset of the neighboor.
+ * @param[out] support_words Domain bitset to fill, must hold get_domain_word_count() words.
+ *
+ * @note Work is per distinct side pattern rather than per slot, tile sets share only a handful of side patterns.
+ **********************************************************************************************************************/
+void D_Tile_Index::side_support(size_t side, uint64_t const *neighboor_domain, uint64_t *support_words) const
+{
+    size_t const mirror = (side + 2) & NEXT_SIDE_IDX_BIT_MASK;
+    std::fill(support_words, support_words + domain_word_count, 0);
+    for (size_t pattern_idx = 0; pattern_idx < side_patterns[mirror].size(); pattern_idx++)
+    {
+        uint64_t const *pattern_words = &side_pattern_words[mirror][pattern_idx * domain_word_count];
+        bool present = false;
+        for (size_t word = 0; word < domain_word_count && !present; word++)
+            present = pattern_words[word] & neighboor_domain[word];
+        if (!present)
+            continue;
+
+        uint64_t const *facing_words = side_pattern_domain(side, reverse_8bits(side_patterns[mirror][pattern_idx]));
+        if (!facing_words)
+            continue;
+        for (size_t word = 0; word < domain_word_count; word++)
+            support_words[word] |= facing_words[word];
+    }
+}
+
+/***********************************************************************************************************************
+ * @brief Gets the domain bitset of every slot that can sit on a side of the given slot, ie whose mirrored side matches
+ * that side exactly. Slots with the same side pattern share one bitset.
+ *
+ * @param[in] slot Slot of the placed tile, or get_empty_slot().
+ * @param[in] side Side index of the neighboor, ie 0 for the neighboor above.
+ *
+ * @retval uint64_t const * Domain bitset of get_domain_word_count() words.
+ *
+ * @warning The slot is not bounds checked.
+ **********************************************************************************************************************/
+uint64_t const *D_Tile_Index::compatible_domain(size_t slot, size_t side) const
+{
+    uint16_t pattern_idx = compatible_patterns[slot][side];
+    if (TILE_INDEX_NO_PATTERN == pattern_idx)
+        return no_domain_words.data();
+    size_t const mirror = (side + 2) & NEXT_SIDE_IDX_BIT_MASK;
+    return &side_pattern_words[mirror][pattern_idx * domain_word_count];
+}